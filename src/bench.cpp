@@ -0,0 +1,72 @@
+// 
+// bench.cpp
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#include "benchmark.h"
+
+void usage(const char* name) {
+    std::cerr << "Usage: " << name << " [options]\n"
+        << "Options: --sizes S,S,..     universe sizes (default: 256,1024,4096,16384,32768)\n"
+        << "         --engines E,E,..   nibble, bitboard, hashlife, plane (default: nibble,bitboard)\n"
+        << "         --kernels K,K,..   nibble kernels scalar, avx2, avx512 (default: widest supported)\n"
+        << "         --seeds S,S,..     random, empty, full, pattern:<id> (default: random,empty,full,pattern:1,pattern:3,pattern:5)\n"
+        << "         --patterns F       pattern file for pattern seeds (default: resources/patterns.txt)\n"
+        << "         --threads T        number of simulation threads (default: all cores)\n"
+        << "         --min-ms M         minimum time per case (default: 500)\n"
+        << "         --max-gens G       maximum generations per case (default: 100000)\n"
+        << "         --json F           also write the results as JSON, - for stdout\n"
+        << "         --quick            sizes 256,1024 and 100 ms per case\n";
+}
+
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items {};
+    std::istringstream stream(list);
+    std::string item;
+    while(std::getline(stream, item, ','))
+        if(!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+int main(int argc, char *argv[]) {
+    BenchmarkOptions options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+
+        if(arg == "--sizes" && hasValue) {
+            options.sizes.clear();
+            for(const std::string& size : split(argv[++i]))
+                options.sizes.push_back(std::stoi(size));
+        } else if(arg == "--engines" && hasValue) {
+            options.engines = split(argv[++i]);
+        } else if(arg == "--kernels" && hasValue) {
+            options.kernels = split(argv[++i]);
+        } else if(arg == "--seeds" && hasValue) {
+            options.seeds = split(argv[++i]);
+        } else if(arg == "--patterns" && hasValue) {
+            options.patternPath = argv[++i];
+        } else if(arg == "--threads" && hasValue) {
+            options.threads = std::stoi(argv[++i]);
+        } else if(arg == "--min-ms" && hasValue) {
+            options.minMs = std::stod(argv[++i]);
+        } else if(arg == "--max-gens" && hasValue) {
+            options.maxGenerations = std::stol(argv[++i]);
+        } else if(arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if(arg == "--quick") {
+            options.sizes = {256, 1024};
+            options.minMs = 100;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner = BenchmarkRunner(options);
+    return runner.run();
+}
@@ -0,0 +1,232 @@
+// 
+// benchmark.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "engines.h"
+#include "patterns.h"
+#include "timer.h"
+
+struct BenchmarkOptions {
+    std::vector<int> sizes = {256, 1024, 4096, 16384, 32768};
+    std::vector<std::string> engines = {"nibble", "bitboard"};
+    std::vector<std::string> kernels = {""};
+    std::vector<std::string> seeds = {"random", "empty", "full", "pattern:1", "pattern:3", "pattern:5"};
+    std::string patternPath = "resources/patterns.txt";
+    std::string jsonPath = "";
+    unsigned int randomSeed = 42;
+    int threads = 0;
+    double minMs = 500;
+    long maxGenerations = 100000;
+};
+
+struct BenchmarkResult {
+    std::string engine;
+    std::string seed;
+    int size = 0;
+    int threads = 0;
+    long generations = 0;
+    double seconds = 0;
+    double bytesPerGeneration = -1; // Negative if the engine gives no estimate
+
+    double cellUpdates() const { return (double) size * size * generations; }
+    double nsPerCellUpdate() const { return seconds * 1e9 / cellUpdates(); }
+    double generationsPerSecond() const { return generations / seconds; }
+};
+
+/*
+ * Runs the step of every engine/kernel over a matrix of universe sizes and seeds.
+ * Each case steps until it took at least minMs (or maxGenerations were computed)
+ * and reports ns per cell update, generations per second and the bytes of cell state
+ * read and written per generation.
+ */
+class BenchmarkRunner {
+    private:
+        BenchmarkOptions options;
+        ThreadPool threadPool;
+        std::vector<std::string> patterns {};
+        std::vector<BenchmarkResult> results {};
+
+    public:
+        BenchmarkRunner(const BenchmarkOptions& options) : options(options), threadPool(options.threads) { }
+
+        int run() {
+            bool usesPatterns = false;
+            for(const std::string& seed : options.seeds)
+                usesPatterns |= seed.rfind("pattern:", 0) == 0;
+            if(usesPatterns && !loadPatternFile(options.patternPath, patterns))
+                return 1;
+
+            printHeader();
+            for(const std::string& engineName : options.engines)
+                for(const std::string& kernel : engineName == "nibble" ? options.kernels : std::vector<std::string>{""})
+                    for(int size : options.sizes)
+                        for(const std::string& seed : options.seeds)
+                            if(!runCase(engineName, kernel, size, seed))
+                                return 1;
+
+            if(!options.jsonPath.empty())
+                return writeJson() ? 0 : 1;
+            return 0;
+        }
+
+    private:
+        bool runCase(const std::string& engineName, const std::string& kernel, int size, const std::string& seed) {
+            Engine* engine = createEngine(engineName, size, size);
+            engine->setKernel(kernel);
+
+            bool seeded = initUniverse(engine, seed);
+            if(!seeded) {
+                delete engine;
+                return false;
+            }
+
+            BenchmarkResult result;
+            result.engine = engine->getName();
+            result.seed = seed;
+            result.size = engine->width;
+            result.threads = threadPool.size();
+
+            double bytes = 0;
+            Timer timer;
+            long ns = 0;
+            while(result.generations < options.maxGenerations && ns < options.minMs * 1e6) {
+                // Estimated before the step, the sparse engines only touch their active tiles
+                bytes += bytesTouched(engine);
+
+                timer.start();
+                engine->step(&threadPool);
+                timer.stop();
+                ns += timer.getNs();
+                result.generations++;
+            }
+            result.seconds = ns / 1e9;
+            result.bytesPerGeneration = bytes < 0 ? -1 : bytes / result.generations;
+
+            delete engine;
+            results.push_back(result);
+            printResult(result);
+            return true;
+        }
+
+        bool initUniverse(Engine* engine, const std::string& seed) {
+            if(seed == "random") {
+                srand(options.randomSeed);
+                engine->initGolRandom();
+            } else if(seed == "empty") {
+                engine->initGolClear();
+            } else if(seed == "full") {
+                engine->initGolFull();
+            } else if(seed.rfind("pattern:", 0) == 0) {
+                int id = std::stoi(seed.substr(8));
+                if(id < 0 || (size_t) id >= patterns.size()) {
+                    std::cerr << "[Benchmark] Invalid pattern id: " << id << "\n";
+                    return false;
+                }
+                engine->initGolClear();
+                // Patterns larger than the universe are skipped with an error by placePattern
+                engine->placePattern(patterns[id]);
+            } else {
+                std::cerr << "[Benchmark] Unknown seed: " << seed << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        /*
+         * Bytes of cell state read and written by the next step, negative if unknown
+         */
+        static double bytesTouched(Engine* engine) {
+            if(Universe* universe = dynamic_cast<Universe*>(engine)) {
+                double active = (double) universe->activeTiles() / (universe->tilesX * universe->tilesY);
+                return active * 2 * universe->arrayLength * sizeof(uint64_t);
+            }
+            if(BitUniverse* universe = dynamic_cast<BitUniverse*>(engine))
+                return 2.0 * universe->arrayLength * sizeof(uint64_t);
+            if(PlaneUniverse* universe = dynamic_cast<PlaneUniverse*>(engine))
+                return (double) universe->getTileCount() * sizeof(PlaneTile);
+            return -1;
+        }
+
+        static std::string formatBytes(double bytes) {
+            if(bytes < 0)
+                return "-";
+            const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+            int unit = 0;
+            while(bytes >= 1024 && unit < 4) {
+                bytes /= 1024;
+                unit++;
+            }
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(1) << bytes << " " << units[unit];
+            return stream.str();
+        }
+
+        void printHeader() {
+            std::cout << std::left << std::setw(16) << "engine" << std::setw(12) << "seed"
+                << std::right << std::setw(8) << "size" << std::setw(10) << "gens"
+                << std::setw(12) << "gens/s" << std::setw(14) << "ns/cell-upd"
+                << std::setw(14) << "bytes/gen" << std::setw(14) << "GB/s" << "\n";
+        }
+
+        void printResult(const BenchmarkResult& r) {
+            double bandwidth = r.bytesPerGeneration < 0 ? -1 : r.bytesPerGeneration * r.generationsPerSecond() / 1e9;
+            std::cout << std::left << std::setw(16) << r.engine << std::setw(12) << r.seed
+                << std::right << std::setw(8) << r.size << std::setw(10) << r.generations
+                << std::fixed << std::setprecision(1) << std::setw(12) << r.generationsPerSecond()
+                << std::setprecision(4) << std::setw(14) << r.nsPerCellUpdate()
+                << std::setw(14) << formatBytes(r.bytesPerGeneration)
+                << std::setprecision(2) << std::setw(14);
+            if(bandwidth < 0)
+                std::cout << "-";
+            else
+                std::cout << bandwidth;
+            std::cout << "\n" << std::defaultfloat << std::flush;
+        }
+
+        bool writeJson() {
+            std::ofstream file;
+            if(options.jsonPath != "-") {
+                file.open(options.jsonPath);
+                if(!file.is_open()) {
+                    std::cerr << "[Benchmark] Failed to write: " << options.jsonPath << "\n";
+                    return false;
+                }
+            }
+            std::ostream& out = options.jsonPath == "-" ? std::cout : file;
+
+            out << "[\n" << std::setprecision(9);
+            for(size_t i = 0; i < results.size(); i++) {
+                const BenchmarkResult& r = results[i];
+                out << "  {\"engine\": \"" << r.engine << "\", \"seed\": \"" << r.seed << "\""
+                    << ", \"size\": " << r.size << ", \"threads\": " << r.threads
+                    << ", \"generations\": " << r.generations << ", \"seconds\": " << r.seconds
+                    << ", \"gens_per_sec\": " << r.generationsPerSecond()
+                    << ", \"ns_per_cell_update\": " << r.nsPerCellUpdate()
+                    << ", \"bytes_per_generation\": ";
+                if(r.bytesPerGeneration < 0)
+                    out << "null";
+                else
+                    out << r.bytesPerGeneration;
+                out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+            }
+            out << "]\n";
+            return out.good();
+        }
+};
+
+#endif /* BENCHMARK_H */
@@ -0,0 +1,280 @@
+// 
+// bitUniverse.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef BITUNIVERSE_H
+#define BITUNIVERSE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+#include "threadPool.h"
+
+/*
+ * Bitboard engine, every array entry packs 64 horizontal cells with one bit per cell.
+ * The leftmost cell of a word is the most significant bit.
+ * There is no count array and the step works in place,
+ * only the rows at the band borders are copied.
+ *
+ * Rows are padded to full words the same way as in the nibble engine,
+ * the first padding cell holds a copy of the first cell of the row and the last padding
+ * cell a copy of the last cell, the neighbours of both edge cells wrap around through them.
+ */
+class BitUniverse : public Engine {
+    public:
+        const int rowLength = 0;
+        const int numRows = 0;
+        const size_t arrayLength = 0;
+
+        uint64_t* cells;
+
+    private:
+        // Reused by every step, the original border rows and the above/current rows of each band
+        std::vector<uint64_t> borders {};
+        std::vector<uint64_t> bandRows {};
+
+    public:
+        BitUniverse(int width, int height) :
+        Engine(std::max(width, 1), std::max(height, 1)),
+        rowLength(paddedRowLength(this->width)), // Every array entry packs 64 horizontal cells
+        numRows(this->height),
+        arrayLength((size_t) rowLength * numRows) {
+            cells = new uint64_t[arrayLength]();
+        }
+
+        ~BitUniverse() {
+            delete[] cells;
+        }
+
+        std::string getName() { return "bitboard"; }
+
+        /*
+         * Words per row, a single padding cell can not mirror both ends of the row
+         */
+        static int paddedRowLength(int width) {
+            int length = (width + 63) / 64;
+            if(length * 64 - width == 1)
+                length++;
+            return length;
+        }
+
+        uint64_t* row(int y) { return cells + (size_t) y * rowLength; }
+
+        void initGolRandom() {
+            generation = 0;
+            initGolClear();
+            for(size_t i = 0; i < arrayLength; i++) {
+                for(int j = 0; j < 64; j++)  {
+                    cells[i] |= (uint64_t) (rand() % 3 < 1) << j;
+                }
+            }
+            updatePadding();
+        }
+
+        void initGolClear() {
+            generation = 0;
+            for(size_t i = 0; i < arrayLength; i++) { cells[i] = 0x0; }
+        }
+
+        void initGolFull() {
+            generation = 0;
+            for(size_t i = 0; i < arrayLength; i++) { cells[i] = ~0x0ull; }
+            updatePadding();
+        }
+
+        /*
+         * Rewrites the padding cells of row y from its first and last cell
+         */
+        void updateRowPadding(int y) {
+            uint64_t* r = row(y);
+            uint64_t first = r[0] >> 63;
+            uint64_t last = (r[(width-1)/64] >> (63 - (width-1)%64)) & 0x1;
+
+            for(int x = width/64; x < rowLength; x++) {
+                int real = std::max(0, width - x*64);
+                uint64_t word = real == 0 ? 0 : r[x] & (~0ull << (64 - real));
+                if(x == width/64)
+                    word |= first << (63 - width%64);
+                if(x == rowLength-1)
+                    word |= last;
+                r[x] = word;
+            }
+        }
+
+        void updatePadding() {
+            if(rowLength * 64 == width)
+                return;
+            for(int y = 0; y < numRows; y++)
+                updateRowPadding(y);
+        }
+
+        /*
+         * Bit-sliced neighbour count, all 64 cells of a word are summed in parallel.
+         * The three cells above and below are added with a full adder each,
+         * the two cells left and right with a half adder.
+         * The next state only depends on whether the sum is 2 or 3,
+         * so the twos are reduced to "exactly one" instead of a full count.
+         */
+        static inline uint64_t nextWord(uint64_t nw, uint64_t n, uint64_t ne,
+                uint64_t w, uint64_t c, uint64_t e,
+                uint64_t sw, uint64_t s, uint64_t se) {
+            uint64_t aW = (n >> 1) | (nw << 63);
+            uint64_t aE = (n << 1) | (ne >> 63);
+            uint64_t cW = (c >> 1) | (w << 63);
+            uint64_t cE = (c << 1) | (e >> 63);
+            uint64_t bW = (s >> 1) | (sw << 63);
+            uint64_t bE = (s << 1) | (se >> 63);
+
+            uint64_t aSum = aW ^ n ^ aE;
+            uint64_t aCarry = (aW & n) | (aE & (aW ^ n));
+            uint64_t bSum = bW ^ s ^ bE;
+            uint64_t bCarry = (bW & s) | (bE & (bW ^ s));
+            uint64_t cSum = cW ^ cE;
+            uint64_t cCarry = cW & cE;
+
+            uint64_t ones = aSum ^ bSum ^ cSum;
+            uint64_t onesCarry = (aSum & bSum) | (cSum & (aSum ^ bSum));
+
+            uint64_t twos = aCarry ^ bCarry ^ cCarry;
+            uint64_t twosCarry = (aCarry & bCarry) | (cCarry & (aCarry ^ bCarry));
+
+            // Sum of the weight two bits equals 1
+            uint64_t exactlyOneTwo = ~twosCarry & (twos ^ onesCarry);
+
+            return exactlyOneTwo & (ones | c);
+        }
+
+        static void nextRow(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+                uint64_t* out, int rowLength) {
+            for(int x = 0; x < rowLength; x++) {
+                int nC = (x + 1) >= rowLength ?           0 : x+1;
+                int pC = (x - 1) <          0 ? rowLength-1 : x-1;
+                out[x] = nextWord(north[pC], north[x], north[nC],
+                        row[pC], row[x], row[nC],
+                        south[pC], south[x], south[nC]);
+            }
+        }
+
+        void step(ThreadPool* pool = nullptr) {
+            int bands = pool == nullptr ? 1 : std::min(pool->size(), numRows);
+
+            // Original first/last row of each band, read by the neighbouring bands
+            borders.resize(2 * bands * rowLength);
+            bandRows.resize(2 * bands * rowLength);
+            for(int b = 0; b < bands; b++) {
+                int rowBegin = (long) numRows * b / bands;
+                int rowEnd = (long) numRows * (b + 1) / bands;
+                std::memcpy(&borders[(2*b) * rowLength], row(rowBegin), rowLength * sizeof(uint64_t));
+                std::memcpy(&borders[(2*b+1) * rowLength], row(rowEnd-1), rowLength * sizeof(uint64_t));
+            }
+
+            auto stepBand = [&](int b) {
+                int rowBegin = (long) numRows * b / bands;
+                int rowEnd = (long) numRows * (b + 1) / bands;
+                const uint64_t* northBorder = &borders[(2*((b - 1 + bands) % bands) + 1) * rowLength];
+                const uint64_t* southBorder = &borders[(2*((b + 1) % bands)) * rowLength];
+
+                uint64_t* above = &bandRows[(2*b) * rowLength];
+                uint64_t* current = &bandRows[(2*b+1) * rowLength];
+                std::memcpy(above, northBorder, rowLength * sizeof(uint64_t));
+                for(int y = rowBegin; y < rowEnd; y++) {
+                    uint64_t* r = row(y);
+                    const uint64_t* below = y + 1 < rowEnd ? r + rowLength : southBorder;
+                    std::memcpy(current, r, rowLength * sizeof(uint64_t));
+                    nextRow(above, current, below, r, rowLength);
+                    if(rowLength * 64 != width)
+                        updateRowPadding(y);
+                    std::swap(above, current);
+                }
+            };
+
+            if(bands == 1)
+                stepBand(0);
+            else
+                pool->parallelFor(0, bands, [&](int bandBegin, int bandEnd) {
+                    for(int b = bandBegin; b < bandEnd; b++)
+                        stepBand(b);
+                });
+
+            generation++;
+        }
+
+        uint64_t population() {
+            int fullWords = width / 64;
+            uint64_t tailMask = width % 64 == 0 ? 0 : ~0ull << (64 - width%64);
+
+            uint64_t alive = 0;
+            for(int y = 0; y < numRows; y++) {
+                const uint64_t* r = row(y);
+                for(int x = 0; x < fullWords; x++)
+                    alive += __builtin_popcountll(r[x]);
+                alive += __builtin_popcountll(r[fullWords % rowLength] & tailMask);
+            }
+            return alive;
+        }
+
+        const uint64_t* getWords(std::string& layout, size_t& rowWords) {
+            layout = "bitboard";
+            rowWords = rowLength;
+            return cells;
+        }
+
+        bool setWords(const std::string& layout, size_t rowWords, const uint64_t* words) {
+            if(layout != "bitboard" || rowWords != (size_t) rowLength)
+                return false;
+            std::memcpy(cells, words, arrayLength * sizeof(uint64_t));
+            return true;
+        }
+
+        bool getCellState(int gx, int gy) {
+            return row(gy)[gx/64] & (1ull << (63 - gx%64));
+        }
+
+        void setCellState(int gx, int gy) {
+            row(gy)[gx/64] |= (1ull << (63 - gx%64));
+            updateRowPadding(gy);
+        }
+
+        void unsetCellState(int gx, int gy) {
+            row(gy)[gx/64] &= ~(1ull << (63 - gx%64));
+            updateRowPadding(gy);
+        }
+
+        void invertCellState(int gx, int gy) {
+            row(gy)[gx/64] ^= (1ull << (63 - gx%64));
+            updateRowPadding(gy);
+        }
+
+        void setRowBits(int gy, int gxBegin, int gxEnd, const uint64_t* src) {
+            uint64_t* r = row(gy);
+            for(int gx = gxBegin; gx < gxEnd;) {
+                int wordEnd = std::min(gxEnd, (gx/64 + 1) * 64);
+                int n = wordEnd - gx;
+                int shift = 64 - gx%64 - n;
+                uint64_t mask = (n == 64 ? ~0ull : (1ull << n) - 1) << shift;
+                r[gx/64] = (r[gx/64] & ~mask) | (extractBits(src, gx - gxBegin, n) << shift);
+                gx = wordEnd;
+            }
+            updateRowPadding(gy);
+        }
+
+        void getRowBits(int gy, int gxBegin, int gxEnd, uint64_t* dst) {
+            std::fill(dst, dst + (gxEnd - gxBegin + 63) / 64, 0);
+            for(int gx = gxBegin; gx < gxEnd;) {
+                int wordEnd = std::min(gxEnd, (gx/64 + 1) * 64);
+                int n = wordEnd - gx;
+                uint64_t bits = row(gy)[gx/64] >> (64 - gx%64 - n);
+                appendBits(dst, gx - gxBegin, n == 64 ? bits : bits & ((1ull << n) - 1), n);
+                gx = wordEnd;
+            }
+        }
+};
+
+#endif /* BITUNIVERSE_H */
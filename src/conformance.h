@@ -0,0 +1,400 @@
+// 
+// conformance.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef CONFORMANCE_H
+#define CONFORMANCE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "engines.h"
+#include "kernel.h"
+#include "threadPool.h"
+
+/*
+ * Straightforward reference of the rules, a set of live cells where every generation
+ * counts the neighbours of each live cell. On a torus the coordinates wrap around,
+ * otherwise the plane is unbounded.
+ */
+class ReferenceUniverse {
+    private:
+        std::unordered_set<uint64_t> alive {};
+
+        static uint64_t key(int x, int y) { return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y; }
+
+    public:
+        const int width;
+        const int height;
+        const bool torus;
+
+        ReferenceUniverse(int width, int height, bool torus) : width(width), height(height), torus(torus) { }
+
+        void set(int x, int y) {
+            if(torus) {
+                x = ((x % width) + width) % width;
+                y = ((y % height) + height) % height;
+            }
+            alive.insert(key(x, y));
+        }
+
+        bool get(int x, int y) const { return alive.count(key(x, y)) != 0; }
+
+        uint64_t population() const { return alive.size(); }
+
+        std::vector<std::pair<int, int>> cells() const {
+            std::vector<std::pair<int, int>> result {};
+            for(uint64_t k : alive)
+                result.push_back({(int32_t) (k >> 32), (int32_t) k});
+            return result;
+        }
+
+        void step() {
+            std::unordered_map<uint64_t, int> counts {};
+            for(auto [x, y] : cells()) {
+                for(int dy = -1; dy <= 1; dy++) {
+                    for(int dx = -1; dx <= 1; dx++) {
+                        if(dx == 0 && dy == 0)
+                            continue;
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if(torus) {
+                            nx = (nx + width) % width;
+                            ny = (ny + height) % height;
+                        }
+                        counts[key(nx, ny)]++;
+                    }
+                }
+            }
+
+            std::unordered_set<uint64_t> next {};
+            for(auto [k, count] : counts)
+                if(count == 3 || (count == 2 && alive.count(k)))
+                    next.insert(k);
+            alive.swap(next);
+        }
+};
+
+struct ConformanceOptions {
+    long generations = 1000;
+    unsigned int seed = 1;
+    int threads = 0;
+    std::string engine = "";    // All engines if empty
+};
+
+/*
+ * Runs every engine (and every supported kernel) next to the reference and compares
+ * the state hashes after each step, on random soups, across the wrap around edges and
+ * with known oscillators and spaceships, which also must return to their (shifted) start.
+ */
+class ConformanceRunner {
+    private:
+        struct KnownPattern {
+            std::string name;
+            std::vector<std::pair<int, int>> cells;
+            int period;
+            int dx;
+            int dy;
+        };
+
+        ConformanceOptions options;
+        ThreadPool threadPool;
+        int passed = 0;
+        int failed = 0;
+
+    public:
+        // At least 4 threads, the bitboard steps one band per thread and the bands must meet in the tests
+        ConformanceRunner(const ConformanceOptions& options) : options(options), 
+        threadPool(options.threads > 0 ? options.threads : std::max(4u, std::thread::hardware_concurrency())) { }
+
+        int run() {
+            std::vector<std::string> engines = {"nibble/scalar", "nibble/avx2", "nibble/avx512", "bitboard", "hashlife", "plane"};
+            for(const std::string& name : engines) {
+                if(!options.engine.empty() && name.rfind(options.engine, 0) != 0)
+                    continue;
+                std::string kernel = name.rfind("nibble/", 0) == 0 ? name.substr(7) : "";
+                if(!kernel.empty() && selectRowKernel(kernel).name != kernel) {
+                    std::cout << "[Verify] " << std::left << std::setw(15) << name << "skipped, not supported by the cpu\n";
+                    continue;
+                }
+                runEngine(name.substr(0, name.find('/')), kernel);
+            }
+
+            std::cout << "[Verify] " << passed << " passed, " << failed << " failed\n";
+            return failed == 0 ? 0 : 1;
+        }
+
+    private:
+        void runEngine(const std::string& name, const std::string& kernel) {
+            // Odd sizes leave partial blocks, words and tiles, 300 x 130 spans several tiles and bands
+            std::vector<std::pair<int, int>> soupSizes = {{64, 64}, {37, 23}, {300, 130}, {3, 40}, {130, 1}};
+            for(auto [width, height] : soupSizes) {
+                srand(options.seed + width * 31 + height);
+                std::vector<std::pair<int, int>> soup {};
+                for(int y = 0; y < height; y++)
+                    for(int x = 0; x < width; x++)
+                        if(rand() % 3 < 1)
+                            soup.push_back({x, y});
+                runCase(name, kernel, "soup", width, height, soup, options.generations, 0);
+            }
+
+            // Production sized soup over 66 tile rows, two tiles and every band, the reference limits it to 64 generations
+            {
+                int width = 300;
+                int height = 4200;
+                srand(options.seed + 7);
+                std::vector<std::pair<int, int>> soup {};
+                for(int y = 0; y < height; y++)
+                    for(int x = 0; x < width; x++)
+                        if(rand() % 3 < 1)
+                            soup.push_back({x, y});
+                runCase(name, kernel, "large soup", width, height, soup, std::min(options.generations, 64L), 0);
+            }
+
+            // Moving southeast across both edges and the corner of the torus
+            std::vector<std::pair<int, int>> gliders = shift(knownPatterns()[2].cells, -2, -2);
+            runCase(name, kernel, "wrap glider", 45, 31, gliders, options.generations, 0);
+
+            for(const KnownPattern& pattern : knownPatterns()) {
+                for(auto [width, height] : std::vector<std::pair<int, int>>{{64, 64}, {45, 31}}) {
+                    std::vector<std::pair<int, int>> cells = shift(pattern.cells, width / 2, height / 2);
+                    long generations = (options.generations / pattern.period) * pattern.period;
+                    if(!runCase(name, kernel, pattern.name, width, height, cells, generations, 0))
+                        continue;
+                    checkPeriod(name, kernel, pattern, width, height);
+                }
+            }
+
+            // HashLife computes jumps of 2^k generations in one step
+            if(name == "hashlife") {
+                srand(options.seed);
+                std::vector<std::pair<int, int>> soup {};
+                for(int y = 0; y < 64; y++)
+                    for(int x = 0; x < 64; x++)
+                        if(rand() % 3 < 1)
+                            soup.push_back({x, y});
+                runCase(name, kernel, "soup jump 2^4", 64, 64, soup, options.generations, 4);
+                checkNodeLimit();
+            }
+        }
+
+        /*
+         * Steps the engine and the reference side by side, returns false on a mismatch.
+         * Cases the engine can not represent (hashlife on other sizes than powers of two) are skipped.
+         */
+        bool runCase(const std::string& name, const std::string& kernel, const std::string& caseName,
+                int width, int height, const std::vector<std::pair<int, int>>& cells, long generations, int stepLog) {
+            if(name == "hashlife" && (HashLife::squareSize(width, height) != width || width != height))
+                return false;
+
+            Engine* engine = createEngine(name, width, height);
+            engine->setKernel(kernel);
+            std::string label = engine->getName();
+            std::string description = caseName + " " + std::to_string(width) + "x" + std::to_string(height);
+
+            ReferenceUniverse reference(width, height, name != "plane");
+            engine->initGolClear();
+            for(auto [x, y] : cells) {
+                reference.set(x, y);
+                if(reference.torus)
+                    engine->setCellState(((x % width) + width) % width, ((y % height) + height) % height);
+                else
+                    engine->setCellState(x, y);
+            }
+
+            std::string mismatch = compare(engine, reference);
+            long stepSize = 1L << stepLog;
+            for(long g = 0; g < generations && mismatch.empty(); g += stepSize) {
+                engine->stepPowerOfTwo(stepLog, &threadPool);
+                for(long i = 0; i < stepSize; i++)
+                    reference.step();
+                mismatch = compare(engine, reference);
+                if(!mismatch.empty())
+                    mismatch = "generation " + std::to_string(g + stepSize) + ", " + mismatch;
+            }
+
+            report(label, description, generations, mismatch);
+            delete engine;
+            return mismatch.empty();
+        }
+
+        /*
+         * After whole periods the pattern must be back in its start shape, shifted by its velocity
+         */
+        void checkPeriod(const std::string& name, const std::string& kernel, const KnownPattern& pattern, int width, int height) {
+            Engine* engine = createEngine(name, width, height);
+            engine->setKernel(kernel);
+
+            ReferenceUniverse expected(width, height, name != "plane");
+            engine->initGolClear();
+            for(auto [x, y] : shift(pattern.cells, width / 2, height / 2)) {
+                engine->setCellState(x, y);
+                expected.set(x + pattern.dx * 8, y + pattern.dy * 8);
+            }
+            for(int g = 0; g < pattern.period * 8; g++)
+                engine->step(&threadPool);
+
+            std::string description = pattern.name + " period " + std::to_string(pattern.period) + " "
+                + std::to_string(width) + "x" + std::to_string(height);
+            report(engine->getName(), description, pattern.period * 8, compare(engine, expected));
+            delete engine;
+        }
+
+        /*
+         * Jumps a soup with the smallest node limit, the node count must stay below it
+         * and the result must match the bitboard stepped one generation at a time
+         */
+        void checkNodeLimit() {
+            int size = 128;
+            int stepLog = 16;
+            HashLife* hashLife = new HashLife(size, size, 1);
+            Engine* expected = createEngine("bitboard", size, size);
+
+            // Built in one go, setting the cells one by one would leave garbage nodes behind
+            srand(options.seed + 3);
+            hashLife->initGolRandom();
+            expected->initGolClear();
+            for(int y = 0; y < size; y++)
+                for(int x = 0; x < size; x++)
+                    if(hashLife->getCellState(x, y))
+                        expected->setCellState(x, y);
+
+            hashLife->stepPowerOfTwo(stepLog, &threadPool);
+            expected->stepPowerOfTwo(stepLog, &threadPool);
+
+            ReferenceUniverse reference(size, size, true);
+            for(int y = 0; y < size; y++)
+                for(int x = 0; x < size; x++)
+                    if(expected->getCellState(x, y))
+                        reference.set(x, y);
+
+            std::string mismatch = compare(hashLife, reference);
+            if(mismatch.empty() && hashLife->getPeakNodeCount() > hashLife->getMaxNodes())
+                mismatch = "peak of " + std::to_string(hashLife->getPeakNodeCount()) + " nodes, limit "
+                    + std::to_string(hashLife->getMaxNodes());
+
+            std::string description = "node limit jump 2^" + std::to_string(stepLog) + " "
+                + std::to_string(size) + "x" + std::to_string(size);
+            report(hashLife->getName(), description, 1L << stepLog, mismatch);
+            delete hashLife;
+            delete expected;
+        }
+
+        /*
+         * Compares the state hashes of engine and reference, describes the first difference if any
+         */
+        std::string compare(Engine* engine, const ReferenceUniverse& reference) {
+            // On the plane the cells can leave the shown area, compared is the bounding box of the reference
+            int xBegin = 0;
+            int yBegin = 0;
+            int xEnd = engine->width;
+            int yEnd = engine->height;
+            if(!reference.torus && reference.population() > 0) {
+                xBegin = yBegin = INT32_MAX;
+                xEnd = yEnd = INT32_MIN;
+                for(auto [x, y] : reference.cells()) {
+                    xBegin = std::min(xBegin, x);
+                    yBegin = std::min(yBegin, y);
+                    xEnd = std::max(xEnd, x + 1);
+                    yEnd = std::max(yEnd, y + 1);
+                }
+            }
+
+            int rowWords = (xEnd - xBegin + 63) / 64;
+            std::vector<uint64_t> engineRow(rowWords);
+            std::vector<uint64_t> referenceRow(rowWords);
+            uint64_t engineHash = 14695981039346656037ull;
+            uint64_t referenceHash = 14695981039346656037ull;
+            for(int y = yBegin; y < yEnd; y++) {
+                engine->getRowBits(y, xBegin, xEnd, engineRow.data());
+                std::fill(referenceRow.begin(), referenceRow.end(), 0);
+                for(int x = xBegin; x < xEnd; x++)
+                    if(reference.get(x, y))
+                        referenceRow[(x - xBegin) / 64] |= 1ull << (63 - (x - xBegin) % 64);
+                engineHash = hash(engineHash, engineRow);
+                referenceHash = hash(referenceHash, referenceRow);
+            }
+
+            uint64_t population = engine->population();
+            if(engineHash == referenceHash && population == reference.population())
+                return "";
+
+            for(int y = yBegin; y < yEnd; y++) {
+                for(int x = xBegin; x < xEnd; x++) {
+                    if(engine->getCellState(x, y) != reference.get(x, y)) {
+                        return "cell (" + std::to_string(x) + ", " + std::to_string(y) + ") is "
+                            + std::to_string(engine->getCellState(x, y)) + ", expected " + std::to_string(reference.get(x, y));
+                    }
+                }
+            }
+            return "population is " + std::to_string(population) + ", expected " + std::to_string(reference.population());
+        }
+
+        static uint64_t hash(uint64_t h, const std::vector<uint64_t>& words) {
+            // FNV-1a over the words
+            for(uint64_t word : words) {
+                h ^= word;
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        void report(const std::string& engineName, const std::string& description, long generations, const std::string& mismatch) {
+            std::cout << "[Verify] " << std::left << std::setw(15) << engineName << std::setw(28) << description
+                << std::right << std::setw(8) << generations << " gens  ";
+            if(mismatch.empty()) {
+                std::cout << "ok\n";
+                passed++;
+            } else {
+                std::cout << "FAILED at " << mismatch << "\n";
+                failed++;
+            }
+        }
+
+        static std::vector<std::pair<int, int>> shift(const std::vector<std::pair<int, int>>& cells, int dx, int dy) {
+            std::vector<std::pair<int, int>> result {};
+            for(auto [x, y] : cells)
+                result.push_back({x + dx, y + dy});
+            return result;
+        }
+
+        static std::vector<KnownPattern> knownPatterns() {
+            return {
+                {"block", {{0, 0}, {1, 0}, {0, 1}, {1, 1}}, 1, 0, 0},
+                {"blinker", {{0, 0}, {1, 0}, {2, 0}}, 2, 0, 0},
+                {"glider", {{1, 0}, {2, 1}, {0, 2}, {1, 2}, {2, 2}}, 4, 1, 1},
+                {"beacon", {{0, 0}, {1, 0}, {0, 1}, {3, 2}, {2, 3}, {3, 3}}, 2, 0, 0},
+                {"lwss", {{1, 0}, {4, 0}, {0, 1}, {0, 2}, {4, 2}, {0, 3}, {1, 3}, {2, 3}, {3, 3}}, 4, -2, 0},
+                {"pulsar", pulsar(), 3, 0, 0},
+            };
+        }
+
+        static std::vector<std::pair<int, int>> pulsar() {
+            // One quadrant mirrored into the other three
+            std::vector<std::pair<int, int>> quadrant = {
+                {2, 0}, {3, 0}, {4, 0}, {0, 2}, {0, 3}, {0, 4}, {5, 2}, {5, 3}, {5, 4}, {2, 5}, {3, 5}, {4, 5}
+            };
+            std::vector<std::pair<int, int>> cells {};
+            for(auto [x, y] : quadrant) {
+                cells.push_back({x - 6, y - 6});
+                cells.push_back({6 - x, y - 6});
+                cells.push_back({x - 6, 6 - y});
+                cells.push_back({6 - x, 6 - y});
+            }
+            return cells;
+        }
+};
+
+#endif /* CONFORMANCE_H */
@@ -10,46 +10,52 @@
 
 #include <SDL3_ttf/SDL_ttf.h>
 #include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <string>
 
+#include "patternIO.h"
+#include "patterns.h"
 #include "sdl3app.h"
+#include "engines.h"
+#include "numberAtlasCache.h"
+#include "simulation.h"
+#include "snapshot.h"
 
 class ConwayApp : public SDLApp {
     private: 
         int minWindowSize = 448;
 
-        const int gameSize = 0;
-        const int rowLength = 0;
-        const int numRows = 0;
-        const int arrayLength = 0;
+        Engine* engine;
+        ThreadPool threadPool;
+        ThreadPool renderPool;
+        Simulation simulation;
+        const int gameWidth = 0;
+        const int gameHeight = 0;
         int minOffset = 50;
         double pointSize = 1.0; 
         int offsetX;
         int offsetY;
-        long generation = 0;
         int zoomFactor;
         SDL_Point zoomIndexOffset;
-        int zoomedSize;
-
-        const uint64_t cellMaskAlive = 0x1;
-        const uint64_t cellMaskCount = 0xF;
+        int zoomedWidth;
+        int zoomedHeight;
 
         const Uint32 cellColorAlive = 0xFFFFFFFF;
         const Uint32 cellColorDead = 0x00000000;
-
-        uint64_t* cells;
-        uint64_t* swap;
-        uint64_t* count;
+        Uint32 densityPalette[256];
+        SDL_Palette* gamePalette = nullptr;
 
         TTF_Font* fontSans = nullptr; 
         bool withTextRendering;
         int textCutoff = 128;
         int fontSize;
 
-        Texture numbers;
-        int maxNumWidth;
-        int maxNumHeight;
+        NumberAtlasCache numberAtlases;
+        NumberAtlasCache::Atlas* numbers = nullptr;
+        bool showZeroCounts = false;
+        std::vector<SDL_Vertex> cellTextVertices {};
+        std::vector<int> cellTextIndices {};
 
         SDL_Point mousePos = {0,0};
         SDL_Point lastMouseCell = {-1,-1};
@@ -62,25 +68,36 @@ class ConwayApp : public SDLApp {
         const int NUMBERKEY_CANCEL = -2;
         Timer numberKeyTimer {}; 
         long numberKeyTimeout = 1000;
-        Texture numberKeysTexture;
 
         bool paused = true;
         bool drawMode = false;
         bool showHelp = false;
-        int advance = 0;
-
-        int pixelPitch;
-        Uint32* pixelData = nullptr;
+        int jumpLog = 10;
+        int maxJumpLog;
+        Speed speed;
+        const int maxGenerationsPerFrame = 1 << 20;
+
+        bool uploadPending = true;
+        int lodLog = 0;
+        int maxTextureSize = 0;
+        CellRegion textureView;
+        int textureLodLog = 0;
+        bool indexedTexture = true;
+        bool gameTextureIndexed = false;
         Texture gameTexture;
-        Texture generationTexture;
+        std::string generationText = "";
         Texture helpTexture;
-        Texture statusTexture;
+        const std::string statusText = "press 'h' for help";
         int statusOffset = 8;
         int helpTextPadding = 100;
         SDL_Point helpTextOffset = {0,0};
 
         std::vector<std::string> patterns {};
 
+        SnapshotWriter snapshotWriter;
+        std::string snapshotPath = "snapshot.gol";
+        std::string tracePath = "trace.json";
+
         std::string helpText = 
             "            --- Help --- \n"
             " \n"
@@ -93,78 +110,119 @@ class ConwayApp : public SDLApp {
             "  left mouse          inspect/draw \n"
             "  esc                 leave mode/selection \n"
             "   \n"
-            "  ctrl-v              paste pattern  \n"
+            "  ctrl-v              paste pattern (plaintext or RLE) \n"
             "  0-9*                load pattern from file \n"
+            "  ctrl-s/ctrl-l       save/load snapshot \n"
             "   \n"
             "  scroll              zoom in/out  \n"
+            "  z                   show/hide zero neighbour counts \n"
             " \n"
             "  space               pause/continue  \n"
             "  right arrow         step \n"
+            "  j                   jump 2^k generations \n"
+            "  up/down arrow       increase/decrease k \n"
+            "  t                   speed mode: uncapped/budget/per frame \n"
+            "  +/-                 increase/decrease speed \n"
+            "  p                   frame profiler \n"
+            "  ctrl-t              start/write trace \n"
             " \n"
             " \n"
-            "Paste patterns must follow the Life Lexicon format. \n"
+            "Paste patterns must be plaintext (Life Lexicon) or RLE. \n"
             "Press escape to close this pop-up. \n";
 
     public:
-        ConwayApp(uint64_t size) : SDLApp("Game of Life", 640,  480), 
-        gameSize(std::max(nextPowerOfTwo(size), 16)), 
-        rowLength(gameSize / 16), // Every array entry packs 16 horizontal cells
-        numRows(gameSize),
-        arrayLength(rowLength * numRows) { 
-
+        ConwayApp(int width, int height, int threads = 0, std::string kernel = "", std::string engineName = "", 
+                size_t memoryLimitMb = 1024) : 
+        SDLApp("Game of Life", 640,  480), 
+        engine(createEngine(engineName, width, height, memoryLimitMb)),
+        threadPool(threads),
+        // A quarter of the simulation's threads expands the texture, both run at the same time
+        renderPool(std::max(1, (threads > 0 ? threads : (int) std::thread::hardware_concurrency()) / 4)),
+        simulation(engine, &threadPool),
+        gameWidth(engine->width),
+        gameHeight(engine->height) { 
+
+            engine->setKernel(kernel);
+            maxJumpLog = engine->getMaxJumpLog();
+            jumpLog = std::min(jumpLog, maxJumpLog);
             zoomIndexOffset = {0,0};
             zoomFactor = 1;
-            zoomedSize = gameSize;
+            zoomedWidth = gameWidth;
+            zoomedHeight = gameHeight;
             helpTexture.setRenderer(renderer);
             helpTexture.loadWrappedText(helpText, monoFont, {255, 255, 255}, 640);
-            numberKeysTexture.setRenderer(renderer);
-            statusTexture.setRenderer(renderer);
-            statusTexture.loadText("press 'h' for help", monoFont, {200, 200, 200});
+
+            // Opened once, the numbers atlases resize it
+            fontSans = TTF_OpenFont((getBasePath() + "../resources/OpenSans-Regular.ttf").c_str(), 12);
+            if(fontSans == nullptr) 
+                error("SDL Font creation failed", SDL_GetError());
+            numberAtlases.setFont(renderer, fontSans);
+            numberAtlases.setTracer(&tracer);
 
             SDL_SetWindowMinimumSize(window, minWindowSize, minWindowSize);
+            maxTextureSize = SDL_GetNumberProperty(SDL_GetRendererProperties(renderer), 
+                    SDL_PROP_RENDERER_MAX_TEXTURE_SIZE_NUMBER, 0);
 
-            cells = new uint64_t[arrayLength];
-            swap = new uint64_t[arrayLength];
-            count = new uint64_t[arrayLength];
-            
-            pixelPitch = gameSize * sizeof(Uint32);
-            pixelData = new Uint32[numRows* pixelPitch/4];
             gameTexture.setRenderer(renderer);
-            gameTexture.loadBlank(gameSize, gameSize, SDL_TEXTUREACCESS_STREAMING, SDL_PIXELFORMAT_RGBA8888);
-            SDL_SetTextureScaleMode(gameTexture.getTexture(), SDL_SCALEMODE_NEAREST);
-            generationTexture.setRenderer(renderer);
-            generationTexture.loadBlank(256, 512, SDL_TEXTUREACCESS_STREAMING, SDL_PIXELFORMAT_ARGB8888);
+            gamePalette = SDL_CreatePalette(256);
+            for(int i = 0; i < 256; i++) {
+                densityPalette[i] = blendColor(cellColorDead, cellColorAlive, i);
+                // RGBA8888
+                SDL_Color color = {(Uint8) (densityPalette[i] >> 24), (Uint8) (densityPalette[i] >> 16), 
+                    (Uint8) (densityPalette[i] >> 8), (Uint8) densityPalette[i]};
+                SDL_SetPaletteColors(gamePalette, &color, i, 1);
+            }
 
             loadPatterns();
             windowResized();
 
-            initGolRandom();
+            engine->initGolRandom();
+            simulation.setPublishCallback([this] { requestRedraw(); });
+            simulation.setTracer(&tracer);
+            simulation.start();
 
-            // std::cout << "requesteSize: " << size << ", gameSize: " << gameSize 
-            //     << ", packedLength: (" << rowLength << ", " << numRows 
-            //     << "), arrayLength: " << arrayLength << "\n";
+            // std::cout << "requestedSize: " << width << "x" << height << ", gameSize: " << gameWidth 
+            //     << "x" << gameHeight << ", engine: " << engine->getName() << "\n";
         }
 
         ~ConwayApp() { 
+            numberAtlases.clear();
             TTF_CloseFont(fontSans);
-            delete[] pixelData;
-            delete[] cells;
-            delete[] swap;
-            delete[] count;
+            simulation.stop();
+            Histogram steps = simulation.getStepHistogram();
+            if(steps.getCount() > 0)
+                std::cout << "[Game of Life] Step times of " << steps.getCount() << " generations: " << steps.toString() << "\n";
+            if(tracer.isEnabled())
+                tracer.write(tracePath);
+            gameTexture.destroy();
+            SDL_DestroyPalette(gamePalette);
+            delete engine;
         }
 
         void windowResized() {
             SDL_GetRenderOutputSize(renderer, &screenWidth, &screenHeight);
-            int size = std::min(screenHeight, screenWidth);
-            pointSize = (float)(size-2*minOffset)/zoomedSize;  
+            pointSize = std::min((float)(screenWidth-2*minOffset)/zoomedWidth, 
+                    (float)(screenHeight-2*minOffset)/zoomedHeight);  
 
-            offsetX = (screenWidth-zoomedSize*pointSize)/2.f;
-            offsetY = (screenHeight-zoomedSize*pointSize)/2.f;
+            offsetX = (screenWidth-zoomedWidth*pointSize)/2.f;
+            offsetY = (screenHeight-zoomedHeight*pointSize)/2.f;
 
             helpTextOffset.x = (screenWidth - helpTexture.getWidth())/2;
             helpTextOffset.y = (screenHeight - helpTexture.getHeight())/2;
 
-            withTextRendering = (zoomedSize <= textCutoff);
+            withTextRendering = (std::max(zoomedWidth, zoomedHeight) <= textCutoff);
+
+            // Level of detail, fewest texels still covering every screen pixel on both axes
+            // and never more than the renderer's largest texture
+            int pixelsX = std::max((int) (zoomedWidth * pointSize), 1);
+            int pixelsY = std::max((int) (zoomedHeight * pointSize), 1);
+            lodLog = 0;
+            while((zoomedWidth >> (lodLog + 1)) >= pixelsX || (zoomedHeight >> (lodLog + 1)) >= pixelsY 
+                    || (maxTextureSize > 0 && std::max(zoomedWidth, zoomedHeight) >> lodLog > maxTextureSize))
+                lodLog++;
+
+            uploadPending = true;
+            simulation.setView(getView(), lodLog, withTextRendering);
 
             loadNumbersTextue();
         }
@@ -173,223 +231,211 @@ class ConwayApp : public SDLApp {
             if(!withTextRendering)
                 return;
 
-            if(fontSans != nullptr) {
-                TTF_CloseFont(fontSans);
-                fontSans = nullptr;
-            }
-
             fontSize = pointSize;
-            fontSans = TTF_OpenFont((getBasePath() + "../resources/OpenSans-Regular.ttf").c_str(), fontSize);
-            if(fontSans == nullptr) 
-                error("SDL Font creation failed", SDL_GetError());
-
-            maxNumWidth = 0;
-            maxNumHeight = 0;
-            Texture* nums = new Texture[9]();
-            for(int i = 0; i < 9; i++) {
-                nums[i].setRenderer(renderer);
-                nums[i].loadText(std::to_string(i), fontSans, {0,0,255});
-                maxNumWidth = std::max(maxNumWidth, nums[i].getWidth());
-                maxNumHeight = std::max(maxNumHeight, nums[i].getHeight());
-            }
+            numbers = numberAtlases.get(fontSize);
+            if(numbers == nullptr)
+                error("Numbers atlas creation failed", SDL_GetError());
+        }
 
-            numbers.setRenderer(renderer);
-            numbers.loadBlank(maxNumWidth*3, maxNumHeight*3, SDL_TEXTUREACCESS_TARGET, nums->getFormat());
-            numbers.setAsRenderTarget();
-            for(int i = 0; i < 9; i++) {
-                int x = (maxNumWidth-nums[i].getWidth())/2;
-                int y = (maxNumHeight-nums[i].getHeight())/2;
-                SDL_FRect dest = {(float)((i%3)*maxNumWidth + x), (float)((int)(i/3)*maxNumHeight + y), 
-                    (float)nums[i].getWidth(), (float)nums[i].getHeight()};
-                nums[i].render(dest.x, dest.y);
-            }
-            SDL_SetRenderTarget(renderer, nullptr);
-            delete[] nums;
+        std::string windowStats() {
+            Histogram steps = simulation.takeStepWindow();
+            return steps.getCount() == 0 ? "" : "step  " + steps.toString();
         }
 
         void loadPatterns() {
-            std::string line;
-            std::string path = getBasePath() + "../resources/patterns.txt";
-            std::ifstream patternFile(path);
-            if(!patternFile.is_open()) {
-                error("Failed to load pattern file", path);
-                return;
-            }
-
-            bool readingPattern = false;
-            std::string pattern = "";
-            while(std::getline(patternFile, line)) {
-                // Trim start
-                line.erase(line.begin(), std::find_if(line.begin(), line.end(), 
-                            [](unsigned char c) { return !std::isspace(c); }));
-
-                if(line.find("//") == 0 || line.empty())
-                    continue;
-
-                if(line.find("{") != std::string::npos) {
-                    readingPattern = true;
-                    continue;
-                } else if(line.find("}") != std::string::npos) {
-                    readingPattern = false;
-                    patterns.push_back(pattern);
-                    pattern = "";
-                    continue;
-                }
-
-                if(!readingPattern)
-                    error("Syntax error in pattern file", line);
-
-                pattern.append(line + "\n");
-            }
+            loadPatternFile(getBasePath() + "../resources/patterns.txt", patterns);
         }
 
         void initGolPattern(int id = 0) {
-            generation = 0;
-            if(id > patterns.size()) {
+            if(id >= patterns.size()) {
                 error("Invalid pattern code", std::to_string(id));
                 return;
             }
 
+            simulation.post([](Engine* e) { e->generation = 0; });
             displayPattern(patterns[id]);
         }
 
-        void debugCellArray() {
-            assert(arrayLength <= 512);
-            std::cout << "Full cell Array: \n";
-            for(int y = 0; y < numRows; y++) {
-                for(int x = 0; x < rowLength; x++) {
-                    std::cout << std::dec << x + y*rowLength << ": " 
-                        << std::hex << cells[x + y * rowLength] 
-                        << std::dec << (x != rowLength-1 ? ", " : "\n"); 
-                }
-            }
-            std::cout << "\n";
+        /*
+         * While paused the image only changes on input or when the simulation
+         * published an edit or step, both wake up the render loop
+         */
+        bool isIdle() {
+            return paused && !uploadPending && !numberKeyTimer.isRunning();
         }
 
-        void initGolRandom() {
-            generation = 0;
-            initGolClear();
-            for(int i = 0; i < arrayLength; i++) { 
-                for(int j = 0; j < 16; j++)  {
-                    cells[i] |= (cellMaskAlive & (rand() % 3 < 1)) << (j*4); 
-                }
-            }
+        /*
+         * Doubles/halves the generations per frame or the time budget per frame
+         */
+        void changeSpeed(bool faster) {
+            if(speed.mode == Speed::PerFrame)
+                speed.generations = std::clamp(faster ? speed.generations * 2 : speed.generations / 2, 
+                        1, maxGenerationsPerFrame);
+            else if(speed.mode == Speed::Budget)
+                speed.budgetMs = std::clamp(faster ? speed.budgetMs * 2 : speed.budgetMs / 2, 1.0, 1000.0);
+            simulation.setSpeed(speed);
         }
 
-        void initGolClear() {
-            generation = 0;
-            for(int i = 0; i < arrayLength; i++) { cells[i] = 0x0; }
+        void cycleSpeedMode() {
+            speed.mode = speed.mode == Speed::Uncapped ? Speed::Budget 
+                : speed.mode == Speed::Budget ? Speed::PerFrame : Speed::Uncapped;
+            simulation.setSpeed(speed);
         }
 
-        void initGolFull() {
-            generation = 0;
-            for(int i = 0; i < arrayLength; i++) { 
-                cells[i] = 0x1111111111111111;
-            }
+        void setPaused(bool p) {
+            paused = p;
+            simulation.setPaused(p);
         }
 
-        /*
-         * More information about this algorithm, see section 2.4 of:
-         * https://www.gathering4gardner.org/g4g13gift/math/RokickiTomas-GiftExchange-LifeAlgorithms-G4G13.pdf  
-         * */
-        void nextBlockState(int x, int y) {
-            int nC = (x + 1) >= rowLength ?           0 : x+1;
-            int pC = (x - 1) <          0 ? rowLength-1 : x-1;
-            int nR = (y + 1) >= numRows   ?           0 : y+1;
-            int pR = (y - 1) <          0 ?   numRows-1 : y-1;
-
-            uint64_t c = cells[x + y * rowLength];
-
-            uint64_t nw = cells[pC + pR * rowLength];
-            uint64_t n  = cells[x  + pR * rowLength];
-            uint64_t ne = cells[nC + pR * rowLength];
-
-            uint64_t e  = cells[nC + y * rowLength];
-            uint64_t w  = cells[pC + y * rowLength];
-
-            uint64_t sw = cells[pC + nR * rowLength];
-            uint64_t s  = cells[x  + nR * rowLength];
-            uint64_t se = cells[nC + nR * rowLength];
-
-            uint64_t r = (c << 4) + (c >> 4) 
-                + (n  << 4) + n + (n  >> 4)
-                + (s  << 4) + s + (s  >> 4)
-                + (nw << 60)  +   (ne >> 60)
-                + (w  << 60)  +   (e  >> 60)
-                + (sw << 60)  +   (se >> 60);
-
-            count[x + y * rowLength] = r;
-            swap[x + y * rowLength] = (r | c) 
-                & (r >> 1) & ~(r >> 2) & ~(r >> 3) 
-                & 0x1111111111111111;
+        CellRegion getView() {
+            return {zoomIndexOffset.x, zoomIndexOffset.y, zoomedWidth, zoomedHeight};
         }
 
+        /*
+         * Uploads the latest generation published by the simulation thread.
+         * Frames only cover the visible cells, the texture is sized to the view.
+         */
         void update() {
-            for(int y = 0; y < numRows; y++) {
-                for(int x = 0; x < rowLength; x++) {
-                    nextBlockState(x, y);
-                    renderBlockToTexture(x,y);
-                }
-            }
-        }
+            if(!simulation.updateFrame() && !uploadPending)
+                return;
 
-        void renderBlockToTexture(int x, int y) {
-            uint64_t c = cells[x + y * rowLength];
-            const int rows = y * pixelPitch/4;
+            // Keep showing the old texture until a frame of the new view arrives
+            const Frame& frame = simulation.getFrame();
+            uploadPending = !(frame.view == getView()) || frame.lodLog != lodLog;
+            if(uploadPending)
+                return;
 
-            // Set pixel color with mask from block (-(0x00...01) = FFFFFFFFFFFFFFFF)
-            for(int i = 0; i < 16; i++) {
-                int s = 4 * ((16-1) - i );
-                pixelData[(x*16) + i + rows] = cellColorAlive & -((c & (cellMaskAlive << s)) >> s);
+            int width = frame.getWidth();
+            int height = frame.getHeight();
+            // Densities are filtered and filtering indices would mix palette entries, LOD frames are RGBA
+            bool indexed = indexedTexture && frame.lodLog == 0;
+            if(!gameTexture.isLoaded() || gameTexture.getWidth() != width || gameTexture.getHeight() != height 
+                    || gameTextureIndexed != indexed)
+                loadGameTexture(width, height, indexed);
+            // Cells stay sharp, densities are filtered down to the screen
+            SDL_SetTextureScaleMode(gameTexture.getTexture(), frame.lodLog > 0 ? SDL_SCALEMODE_LINEAR : SDL_SCALEMODE_NEAREST);
+            // Only the complete texels, an incomplete last column or row of squares is not part of the frame
+            textureView = {frame.view.x, frame.view.y, std::min(width << frame.lodLog, frame.view.width), 
+                std::min(height << frame.lodLog, frame.view.height)};
+            textureLodLog = frame.lodLog;
+
+            // Expand the cell bits straight into the texture memory, no intermediate pixel buffer
+            void* pixels = nullptr;
+            int pitch = 0;
+            if(!gameTexture.lock(nullptr, &pixels, &pitch)) {
+                error("SDL_LockTexture failed", SDL_GetError());
+                return;
             }
+
+            renderPool.parallelFor(0, height, [&](int rowBegin, int rowEnd) {
+                for(int y = rowBegin; y < rowEnd; y++) {
+                    Uint32* row = (Uint32*) ((Uint8*) pixels + (size_t) y * pitch);
+                    if(gameTextureIndexed)
+                        frame.expandRowIndexed(y, (Uint8*) row);
+                    else if(frame.lodLog > 0)
+                        frame.expandDensityRow(y, row, densityPalette);
+                    else
+                        frame.expandRow(y, row, cellColorAlive, cellColorDead);
+                }
+            }, 64);
+            gameTexture.unlock();
         }
 
-        void updateCellText() {
-            for(int y = zoomIndexOffset.y; y < zoomIndexOffset.y + zoomedSize; y++) {
-                for(int x = std::floor(zoomIndexOffset.x/16.f); 
-                        x < std::ceil((zoomIndexOffset.x + zoomedSize)/16.f); x++) {
-                    renderBlockTextToTexture(x,y);
+        /*
+         * Cell frames use an 8 bit indexed texture, one byte per texel instead of four,
+         * palette entries 0 to 255 range from dead to alive. 
+         * Density frames and renderers without indexed textures use RGBA.
+         */
+        void loadGameTexture(int width, int height, bool indexed) {
+            gameTextureIndexed = false;
+            if(indexed) {
+                if(gameTexture.loadBlank(width, height, SDL_TEXTUREACCESS_STREAMING, SDL_PIXELFORMAT_INDEX8) 
+                        && gameTexture.setPalette(gamePalette)) {
+                    gameTextureIndexed = true;
+                    return;
                 }
+                error("Indexed game texture not supported, using RGBA", SDL_GetError());
+                indexedTexture = false;
             }
+
+            gameTexture.loadBlank(width, height, SDL_TEXTUREACCESS_STREAMING, SDL_PIXELFORMAT_RGBA8888);
         }
 
-        void renderBlockTextToTexture(int x, int y) {
-            uint64_t blockCount = count[x + y * rowLength];
+        /*
+         * Draws the part of the texture inside the view, 
+         * the texture can still hold the previous view while zooming
+         */
+        void renderGame() {
+            if(!gameTexture.isLoaded())
+                return;
 
-            for(int i = 0; i < 16; i++) {
-                int s = 4 * ((16-1) - i);
-                int c = (blockCount & (cellMaskCount << s)) >> s;
+            int x0 = std::max(textureView.x, zoomIndexOffset.x);
+            int y0 = std::max(textureView.y, zoomIndexOffset.y);
+            int x1 = std::min(textureView.x + textureView.width, zoomIndexOffset.x + zoomedWidth);
+            int y1 = std::min(textureView.y + textureView.height, zoomIndexOffset.y + zoomedHeight);
+            if(x1 <= x0 || y1 <= y0)
+                return;
 
-                int xPos = (x * 16) + i;
+            float texelSize = 1 << textureLodLog;
+            SDL_FRect clip = {(x0 - textureView.x) / texelSize, (y0 - textureView.y) / texelSize, 
+                (x1 - x0) / texelSize, (y1 - y0) / texelSize};
+            gameTexture.render(offsetX + (x0 - zoomIndexOffset.x) * pointSize, 
+                    offsetY + (y0 - zoomIndexOffset.y) * pointSize, 
+                    (x1 - x0) * pointSize, (y1 - y0) * pointSize, &clip);
+        }
 
-                if(xPos < zoomIndexOffset.x || xPos >= (zoomIndexOffset.x + zoomedSize) 
-                        || y < zoomIndexOffset.y || y >= (zoomIndexOffset.y + zoomedSize))
-                    continue;
+        /*
+         * Draws the neighbour counts of all visible cells in a single draw call,
+         * one quad per cell textured from the numbers atlas. The buffers are reused across frames.
+         */
+        void updateCellText() {
+            // Counts of the previous zoom level until the simulation published the new view
+            const Frame& frame = simulation.getFrame();
+            if(!frame.withCounts || !(frame.view == getView()) || numbers == nullptr || !numbers->texture->isLoaded())
+                return;
 
-                SDL_FRect point = {
-                    (float)(offsetX + (xPos-zoomIndexOffset.x) * pointSize),
-                    (float)(offsetY + (y - zoomIndexOffset.y)  * pointSize),
-                    (float)pointSize, (float)pointSize};
-                SDL_FRect clip = {
-                    (float)(     (c%3) * maxNumWidth),
-                    (float)((int)(c/3) * maxNumHeight),
-                    (float)maxNumWidth, (float)maxNumHeight};
-                SDL_FRect textRect = {
-                    (float)(point.x + (pointSize - maxNumWidth)/2.f),
-                    (float)(point.y + (pointSize-maxNumHeight)/2.f),
-                    (float)maxNumWidth, (float)maxNumHeight};
-                numbers.render(textRect.x, textRect.y, &clip);
+            cellTextVertices.clear();
+            cellTextIndices.clear();
+            int maxNumWidth = numbers->maxNumWidth;
+            int maxNumHeight = numbers->maxNumHeight;
+            float glyphWidth = (float) maxNumWidth / numbers->texture->getWidth();
+            float glyphHeight = (float) maxNumHeight / numbers->texture->getHeight();
+            SDL_FColor color = {1.f, 1.f, 1.f, 1.f};
+
+            for(int y = zoomIndexOffset.y; y < zoomIndexOffset.y + zoomedHeight; y++) {
+                for(int x = zoomIndexOffset.x; x < zoomIndexOffset.x + zoomedWidth; x++) {
+                    int c = frame.getNeighbourCount(x, y);
+                    if(c == 0 && !showZeroCounts)
+                        continue;
+
+                    float left = offsetX + (x - zoomIndexOffset.x) * pointSize + (pointSize - maxNumWidth)/2.f;
+                    float top = offsetY + (y - zoomIndexOffset.y) * pointSize + (pointSize - maxNumHeight)/2.f;
+                    float u = (c%3) * glyphWidth;
+                    float v = (c/3) * glyphHeight;
+
+                    int first = cellTextVertices.size();
+                    cellTextVertices.push_back({{left, top}, color, {u, v}});
+                    cellTextVertices.push_back({{left + maxNumWidth, top}, color, {u + glyphWidth, v}});
+                    cellTextVertices.push_back({{left + maxNumWidth, top + maxNumHeight}, color, {u + glyphWidth, v + glyphHeight}});
+                    cellTextVertices.push_back({{left, top + maxNumHeight}, color, {u, v + glyphHeight}});
+                    for(int i : {0, 1, 2, 0, 2, 3})
+                        cellTextIndices.push_back(first + i);
+                }
             }
+
+            if(!cellTextIndices.empty())
+                SDL_RenderGeometry(renderer, numbers->texture->getTexture(), cellTextVertices.data(), cellTextVertices.size(), 
+                        cellTextIndices.data(), cellTextIndices.size());
         }
 
         void focus() {
-            int gx = focusCell.x % gameSize;
-            int gy = focusCell.y % gameSize;
+            int gx = focusCell.x % gameWidth;
+            int gy = focusCell.y % gameHeight;
 
-            int n = (gy-1 < 0 ? gameSize-1 : gy-1);
-            int e = (gx+1 >= gameSize ? 0 : gx+1);
-            int s = (gy+1 >= gameSize ? 0 : gy+1);
-            int w = (gx-1 < 0 ? gameSize-1 : gx-1);
+            int n = (gy-1 < 0 ? gameHeight-1 : gy-1);
+            int e = (gx+1 >= gameWidth ? 0 : gx+1);
+            int s = (gy+1 >= gameHeight ? 0 : gy+1);
+            int w = (gx-1 < 0 ? gameWidth-1 : gx-1);
 
             const SDL_Point neighbours[] = { 
                 {w, n}, {gx, n}, {e, n}, 
@@ -405,9 +451,10 @@ class ConwayApp : public SDLApp {
             for(int i = 0; i < std::size(neighbours); i++) {
                 int px = neighbours[i].x;
                 int py = neighbours[i].y;
-                if(!getCellState(px,py) 
-                        || px < zoomIndexOffset.x || px >= (zoomedSize + zoomIndexOffset.x)
-                        || py < zoomIndexOffset.y || py >= (zoomedSize + zoomIndexOffset.y))
+                if(px < zoomIndexOffset.x || px >= (zoomedWidth + zoomIndexOffset.x)
+                        || py < zoomIndexOffset.y || py >= (zoomedHeight + zoomIndexOffset.y)
+                        || !simulation.getFrame().contains(px, py)
+                        || !simulation.getFrame().getCellState(px,py))
                     continue;
                 SDL_FRect point = {
                     (float)(offsetX + (px-zoomIndexOffset.x) * pointSize), 
@@ -422,44 +469,37 @@ class ConwayApp : public SDLApp {
         }
 
         void render() {
-            // TODO: Maybe save update calculations
-            // if paused and already calculated 
-            // (always set calculated to false when swaping, 
-            // set it to true after calculation)
-            // don't forget to disable surface invalidation
-            update(); 
-            
-            SDL_Rect zoomedUpdateClip = {0, zoomIndexOffset.y, pixelPitch/4, zoomedSize};
-            gameTexture.update((pixelData + zoomIndexOffset.y * pixelPitch/4), pixelPitch, &zoomedUpdateClip);
-
-            SDL_FRect zoomClip = {(float)(zoomIndexOffset.x), (float)(zoomIndexOffset.y), 
-                (float)(zoomedSize), (float)(zoomedSize)};
-            gameTexture.render(offsetX, offsetY, zoomedSize * pointSize, zoomedSize * pointSize, &zoomClip);
-
-            if(withTextRendering)
+            profiler.record("step", simulation.takeStepNs(), Profiler::SimulationThread);
+            profiler.record("rasterize", simulation.takeRasterizeNs(), Profiler::SimulationThread);
+
+            {
+                ProfileZone zone(profiler, "upload");
+                update(); 
+            }
+
+            {
+                ProfileZone zone(profiler, "game");
+                renderGame();
+            }
+
+            if(withTextRendering) {
+                ProfileZone zone(profiler, "cell text");
                 updateCellText();
+            }
 
+            ProfileZone zone(profiler, "overlays");
             if(focusCell.x != -1 && focusCell.y != -1)
                 focus();
 
             renderDebugRect("Conway's Game of Life", offsetX, offsetY, 
-                    zoomedSize * pointSize, zoomedSize * pointSize); 
-
-            if(!paused || advance > 0) {
-                uint64_t* temp = cells;
-                cells = swap;
-                swap = temp;
-                generation++;
-            }
-
-            if(advance > 0)
-                advance--;
+                    zoomedWidth * pointSize, zoomedHeight * pointSize); 
 
             renderGeneration();
 
             onNumberKey(NUMBERKEY_UPDATE);
-            if(numberKeysTexture.isLoaded())
-                numberKeysTexture.render(screenWidth-numberKeysTexture.getWidth()-statusOffset, statusOffset);
+            if(!numberKeys.empty())
+                monoGlyphs.render(numberKeys, screenWidth-monoGlyphs.getTextWidth(numberKeys)-statusOffset, 
+                        statusOffset, {255, 255, 255, 255});
 
             if(showHelp) {
                 SDL_FRect helpBackground = {(float)helpTextOffset.x - helpTextPadding, 
@@ -473,118 +513,89 @@ class ConwayApp : public SDLApp {
                 helpTexture.render(helpTextOffset.x, helpTextOffset.y);
             }
 
-            statusTexture.render(statusOffset, screenHeight-statusOffset-statusTexture.getHeight());
+            monoGlyphs.render(statusText, statusOffset, screenHeight-statusOffset-monoGlyphs.getTextHeight(statusText), 
+                    {200, 200, 200, 255});
+        }
+
+        void renderGeneration() {
+            char text[128];
+            int length = snprintf(text, sizeof(text), "Gen: %lld  (j: 2^%d, %s)", 
+                    (long long) simulation.getFrame().generation, jumpLog, speed.toString().c_str());
+            generationText.assign(text, std::min(length, (int) sizeof(text) - 1));
+
+            monoGlyphs.render(generationText, (screenWidth - monoGlyphs.getTextWidth(generationText))/2.f, 
+                    10.f, {255, 255, 255, 255});
         }
 
         /*
-         * Computes the next closest power of two
-         * More information: https://graphics.stanford.edu/%7Eseander/bithacks.html#RoundUpPowerOf2
+         * Plaintext (Life Lexicon) or RLE pattern, e.g. from the clipboard
          */
-        int nextPowerOfTwo(uint64_t n) {
-            n--;
-            n |= n >> 1;
-            n |= n >> 2;
-            n |= n >> 4;
-            n |= n >> 8;
-            n |= n >> 16;
-            n |= n >> 32;
-            return ++n;
+        void displayPattern(const std::string& patternStr) {
+            setPaused(true);
+            if(isRle(patternStr)) {
+                simulation.post([patternStr](Engine* e) { 
+                    std::istringstream stream(patternStr);
+                    readRle(stream, e); 
+                });
+                return;
+            }
+            simulation.post([patternStr](Engine* e) { e->placePattern(patternStr); });
         }
 
-        bool getCellState(int gx, int gy) {
-            int offset = (15 - gx%16) * 4;
-            uint64_t block = cells[gx/16 + gy * rowLength];
-
-            return block & (cellMaskAlive << offset);
-        }
+        void setSnapshotPath(const std::string& path) { snapshotPath = path; }
 
-        void invertCellState(int gx, int gy) {
-            int offset = (15-gx%16) * 4;
-            uint64_t block = cells[gx/16 + gy * rowLength];
-            cells[gx/16 + gy * rowLength] = block ^ (cellMaskAlive << offset);
+        /*
+         * Records a trace from now on, written on exit or with ctrl-t
+         */
+        void startTrace(const std::string& path) {
+            tracePath = path;
+            tracer.start();
         }
 
-        void setCellState(int gx, int gy) {
-            int offset = (15-gx%16) * 4;
-            uint64_t block = cells[gx/16 + gy * rowLength];
-            cells[gx/16 + gy * rowLength] = block | (cellMaskAlive << offset);
+        void toggleTrace() {
+            if(!tracer.isEnabled()) {
+                tracer.start();
+                return;
+            }
+            tracer.write(tracePath);
+            tracer.stop();
         }
 
-        void unsetCellState(int gx, int gy) {
-            int offset = (15-gx%16) * 4;
-            uint64_t block = cells[gx/16 + gy * rowLength];
-            cells[gx/16 + gy * rowLength] = block & ~(cellMaskAlive << offset);
+        /*
+         * Snapshots are taken on the simulation thread between two generations,
+         * writing them to disk does not hold up the simulation
+         */
+        void saveSnapshot() {
+            simulation.post([this](Engine* e) { snapshotWriter.save(e, snapshotPath); });
         }
 
-        void renderGeneration() {
-            std::string str = "Gen: " + std::to_string(generation);
-            SDL_Surface* textSurface = TTF_RenderText_Blended(monoFont, 
-                    str.c_str(), str.length(), {255, 255, 255});
-            SDL_FRect fclip = {0.0, 0.0, (float)textSurface->w, (float)textSurface->h};
-            generationTexture.update(textSurface);
-
-            generationTexture.render((screenWidth - textSurface->w)/2.f, 
-                    10.f, &fclip);
-            SDL_DestroySurface(textSurface);
+        void openSnapshot(const std::string& path) {
+            setPaused(true);
+            snapshotPath = path;
+            simulation.post([path](Engine* e) { loadSnapshot(path, e); });
         }
 
         /*
-         * Parses a game of life pattern string 
-         * where 'O' is a live cell and all other characters dead cells.
-         * Such pattern can be found at:
-         * http://www.radicaleye.com/lifepage/lexicon.html         
+         * Replaces the universe with a pattern file, .rle and .mc files are streamed
+         * on the simulation thread, other files are pattern collections like resources/patterns.txt
          */
-        void displayPattern(const std::string& patternStr) {
-            char alive = 'O';
-            char dead = '.';
-
-            int lineLength = 0;
-            std::vector<std::string> lines {};
-
-            std::string line;    
-            std::istringstream stream(patternStr);
-            while (std::getline(stream, line)) {
-                // Trim start/end
-                line.erase(line.begin(), std::find_if(line.begin(), line.end(), 
-                            [](unsigned char c) { return !std::isspace(c); }));
-                line.erase(std::find_if(line.rbegin(), line.rend(), [](unsigned char c) 
-                            { return !std::isspace(c); }).base(), line.end());
-
-                if(lineLength == 0)
-                    lineLength = line.length();
-
-                if(line.length() != lineLength) {
-                    error("Pasted pattern contains uneven line lengths");
-                    return;
-                }
-
-                lines.push_back(line);
-            }
-
-            if(lines.size() > gameSize || lineLength > gameSize) {
-                error("Pasted pattern is too large for game of size", std::to_string(gameSize));
+        void openPattern(const std::string& path, int id = 0) {
+            setPaused(true);
+            if(isRleOrMacrocell(path)) {
+                simulation.post([path](Engine* e) { 
+                    e->initGolClear(); 
+                    loadPattern(path, e); 
+                });
                 return;
             }
 
-            paused = true;
-            // initGolClear();
-
-            int offsetX = (gameSize - lineLength)/2;
-            int offsetY = (gameSize - lines.size())/2;
-
-            int gx = 0;
-            int gy = 0;
-            for(int i = 0; i < lines.size(); i++) {
-                gx = 0;
-                for(int c = 0; c < lines[i].length(); c++) {
-                    if(lines[i].at(c) == alive)
-                        setCellState(offsetX + gx, offsetY + gy);          
-                    else if(lines[i].at(c) == dead)
-                        unsetCellState(offsetX + gx, offsetY + gy);          
-                    gx++;
-                }
-                gy++;
+            std::vector<std::string> filePatterns {};
+            if(!loadPatternFile(path, filePatterns) || id < 0 || (size_t) id >= filePatterns.size()) {
+                error("Invalid pattern file", path);
+                return;
             }
+            simulation.post([](Engine* e) { e->initGolClear(); });
+            displayPattern(filePatterns[id]);
         }
 
         void mouseDownEventHandler(SDL_Event& event) {
@@ -606,8 +617,8 @@ class ConwayApp : public SDLApp {
         }
 
         void mouseInteraction(bool isClick) {
-            if(mousePos.x < offsetX || mousePos.x >= offsetX + zoomedSize*pointSize ||
-                    mousePos.y < offsetY || mousePos.y >= offsetY + zoomedSize*pointSize) {
+            if(mousePos.x < offsetX || mousePos.x >= offsetX + zoomedWidth*pointSize ||
+                    mousePos.y < offsetY || mousePos.y >= offsetY + zoomedHeight*pointSize) {
                 focusCell = {-1,-1};
                 drawMode = false;
                 return;
@@ -616,15 +627,16 @@ class ConwayApp : public SDLApp {
             SDL_Point cellPos = getCellPosFromScreenPos(mousePos); 
 
             if(isClick)
-                mouseCellState = getCellState(cellPos.x, cellPos.y);
+                mouseCellState = simulation.getFrame().contains(cellPos.x, cellPos.y) 
+                    && simulation.getFrame().getCellState(cellPos.x, cellPos.y);
 
             if(cellPos.x  == lastMouseCell.x && cellPos.y == lastMouseCell.y)
                 return;
 
             if(drawMode && !mouseCellState) {
-                setCellState(cellPos.x, cellPos.y);
+                simulation.post([cellPos](Engine* e) { e->setCellState(cellPos.x, cellPos.y); });
             } else if(drawMode && mouseCellState) {
-                unsetCellState(cellPos.x, cellPos.y);
+                simulation.post([cellPos](Engine* e) { e->unsetCellState(cellPos.x, cellPos.y); });
             } else {
                 focusCell = {cellPos.x, cellPos.y};
             }
@@ -652,31 +664,33 @@ class ConwayApp : public SDLApp {
         void zoom(float amount) {
             SDL_Point mouseCell = getCellPosFromScreenPos(mousePos);
             bool useMousePos = isInRect(mousePos, {offsetX, offsetY, 
-                    (int)(zoomedSize*pointSize), (int)(zoomedSize*pointSize)});
-            int maxZoom = gameSize/2;
+                    (int)(zoomedWidth*pointSize), (int)(zoomedHeight*pointSize)});
+            int maxZoom = std::max(std::max(gameWidth, gameHeight)/2, 1);
             if(amount > 0 && zoomFactor != maxZoom) {
                 zoomFactor = std::min(zoomFactor * 2, maxZoom);            
-                zoomedSize = gameSize / zoomFactor;
-                zoomIndexOffset.x = std::min(std::min(std::max((useMousePos ? 
-                                    mouseCell.x - zoomedSize/2 
-                                    : (gameSize-zoomedSize)/2), 0), gameSize-2), gameSize - zoomedSize);
-                zoomIndexOffset.y = std::min(std::min(std::max((useMousePos ? 
-                                    mouseCell.y - zoomedSize/2 
-                                    : (gameSize-zoomedSize)/2), 0), gameSize-2), gameSize - zoomedSize);
-                windowResized();
+                zoomTo(mouseCell, useMousePos);
             } else if(amount < 0 && zoomFactor != 1) {
                 zoomFactor = std::max(zoomFactor / 2, 1);
-                zoomedSize = gameSize / zoomFactor;
-                zoomIndexOffset.x = std::min(std::min(std::max((useMousePos ? 
-                                    mouseCell.x - zoomedSize/2 
-                                    : (gameSize-zoomedSize)/2), 0), gameSize-2), gameSize - zoomedSize);
-                zoomIndexOffset.y = std::min(std::min(std::max((useMousePos ? 
-                                    mouseCell.y - zoomedSize/2 
-                                    : (gameSize-zoomedSize)/2), 0), gameSize-2), gameSize - zoomedSize);
-                windowResized();
+                zoomTo(mouseCell, useMousePos);
             }
         } 
 
+        /*
+         * Centers the view of the current zoom factor on the cell or the universe
+         */
+        void zoomTo(const SDL_Point& cell, bool useCell) {
+            // The short side of a thin universe stops at one cell
+            zoomedWidth = std::max(gameWidth / zoomFactor, 1);
+            zoomedHeight = std::max(gameHeight / zoomFactor, 1);
+            zoomIndexOffset.x = std::max(std::min(std::min(std::max((useCell ? 
+                                cell.x - zoomedWidth/2 
+                                : (gameWidth-zoomedWidth)/2), 0), gameWidth-2), gameWidth - zoomedWidth), 0);
+            zoomIndexOffset.y = std::max(std::min(std::min(std::max((useCell ? 
+                                cell.y - zoomedHeight/2 
+                                : (gameHeight-zoomedHeight)/2), 0), gameHeight-2), gameHeight - zoomedHeight), 0);
+            windowResized();
+        }
+
         void onNumberKey(int n) {
             bool running = numberKeyTimer.isRunning();
             if(!running && n == NUMBERKEY_UPDATE) 
@@ -687,7 +701,6 @@ class ConwayApp : public SDLApp {
 
             if(n == NUMBERKEY_CANCEL) {
                 numberKeys = "";
-                numberKeysTexture.destroy();
                 numberKeyTimer.stop();
                 return;
             } else if(n == NUMBERKEY_UPDATE && running) {
@@ -698,7 +711,6 @@ class ConwayApp : public SDLApp {
                     convert >> patternId;
                     initGolPattern(patternId);
                     numberKeys = "";
-                    numberKeysTexture.destroy();
                     numberKeyTimer.stop();
                     return;
                 }
@@ -713,21 +725,24 @@ class ConwayApp : public SDLApp {
                 numberKeyTimer.resume();
 
             numberKeys.append(std::to_string(n));
-            numberKeysTexture.loadText(numberKeys, monoFont, {255,255,255});
         }
 
         void keyDownEventHandler(SDL_Event& event) {
             switch(event.key.key) {
                 case SDLK_SPACE:
                     drawMode = false;
-                    paused = !paused;
+                    setPaused(!paused);
                     focusCell = {-1,-1};
                     break;
 
                 case SDLK_H: showHelp = !showHelp; break;
 
+                case SDLK_P: showProfiler = !showProfiler; break;
+
+                case SDLK_Z: showZeroCounts = !showZeroCounts; break;
+
                 case SDLK_R:
-                             initGolRandom();
+                             simulation.post([](Engine* e) { e->initGolRandom(); });
                              focusCell = {-1,-1};
                              break;
 
@@ -739,27 +754,53 @@ class ConwayApp : public SDLApp {
                              break;
 
                 case SDLK_C:
-                             initGolClear();
+                             simulation.post([](Engine* e) { e->initGolClear(); });
                              break;
 
                 case SDLK_D:
                              drawMode = !drawMode;
-                             paused = true;
+                             setPaused(true);
                              focusCell = {-1,-1};
                              break;
 
                 case SDLK_UP:
+                             jumpLog = std::min(jumpLog + 1, maxJumpLog);
                              break;
 
                 case SDLK_DOWN:
+                             jumpLog = std::max(jumpLog - 1, 0);
+                             break;
+
+                case SDLK_J:
+                             setPaused(true);
+                             simulation.jumpOnce(jumpLog);
+                             focusCell = {-1,-1};
+                             break;
+
+                case SDLK_T:
+                             if(isCommandModifier())
+                                 toggleTrace();
+                             else
+                                 cycleSpeedMode();
+                             break;
+
+                case SDLK_PLUS:
+                case SDLK_EQUALS:
+                case SDLK_KP_PLUS:
+                             changeSpeed(true);
+                             break;
+
+                case SDLK_MINUS:
+                case SDLK_KP_MINUS:
+                             changeSpeed(false);
                              break;
 
                 case SDLK_LEFT:
                              break;
 
                 case SDLK_RIGHT:
-                             paused = true;
-                             advance++;
+                             setPaused(true);
+                             simulation.stepOnce();
                              focusCell = {-1,-1};
                              break;
 
@@ -774,9 +815,19 @@ class ConwayApp : public SDLApp {
                 case SDLK_9: onNumberKey(9); break;
                 case SDLK_0: onNumberKey(0); break;
 
+                case SDLK_S:
+                             if(isCommandModifier())
+                                 saveSnapshot();
+                             break;
+
+                case SDLK_L:
+                             if(isCommandModifier())
+                                 openSnapshot(snapshotPath);
+                             break;
+
                 case SDLK_V: 
-                             if(isPaste()) {
-                                 paused = true;
+                             if(isCommandModifier()) {
+                                 setPaused(true);
                                  drawMode = false;
                                  displayPattern(SDL_GetClipboardText());
                              }
@@ -787,7 +838,7 @@ class ConwayApp : public SDLApp {
             }
         }
 
-        bool isPaste() {
+        bool isCommandModifier() {
             SDL_Keymod modifier = SDL_GetModState();
             return (modifier == SDL_KMOD_LCTRL) 
                 | (modifier == SDL_KMOD_RCTRL) 
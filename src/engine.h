@@ -0,0 +1,276 @@
+// 
+// engine.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "threadPool.h"
+
+/*
+ * Common interface of all simulation engines.
+ * The universe is a torus of width x height cells,
+ * engines only differ in storage layout and step algorithm.
+ */
+class Engine {
+    public:
+        const int width = 0;
+        const int height = 0;
+        long generation = 0;
+
+    public:
+        Engine(int width, int height) : width(width), height(height) { }
+        virtual ~Engine() { }
+
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        virtual std::string getName() = 0;
+
+        virtual void step(ThreadPool* pool = nullptr) = 0;
+
+        /*
+         * Advances 2^log2Generations generations, engines that can skip ahead override this
+         */
+        virtual void stepPowerOfTwo(int log2Generations, ThreadPool* pool = nullptr) {
+            for(long i = 0; i < (1L << log2Generations); i++)
+                step(pool);
+        }
+
+        /*
+         * True if stepPowerOfTwo skips ahead instead of stepping every generation
+         */
+        virtual bool hasNativeJump() { return false; }
+
+        /*
+         * Largest jump offered interactively, without a native jump every generation is stepped
+         */
+        virtual int getMaxJumpLog() { return 16; }
+
+        virtual void initGolRandom() = 0;
+        virtual void initGolClear() = 0;
+        virtual void initGolFull() = 0;
+
+        virtual bool getCellState(int gx, int gy) = 0;
+        virtual void setCellState(int gx, int gy) = 0;
+        virtual void unsetCellState(int gx, int gy) = 0;
+
+        virtual void invertCellState(int gx, int gy) {
+            if(getCellState(gx, gy))
+                unsetCellState(gx, gy);
+            else
+                setCellState(gx, gy);
+        }
+
+        virtual uint64_t population() {
+            uint64_t alive = 0;
+            for(int gy = 0; gy < height; gy++)
+                for(int gx = 0; gx < width; gx++)
+                    alive += getCellState(gx, gy);
+            return alive;
+        }
+
+        virtual int getNeighbourCount(int gx, int gy) {
+            int count = 0;
+            for(int dy = -1; dy <= 1; dy++) {
+                for(int dx = -1; dx <= 1; dx++) {
+                    if(dx == 0 && dy == 0)
+                        continue;
+                    count += getCellState((gx + dx + width) % width, (gy + dy + height) % height);
+                }
+            }
+            return count;
+        }
+
+        /*
+         * Writes the states of the cells [gxBegin, gxEnd) of a row to dst with one bit per cell,
+         * cell gxBegin is the most significant bit of dst[0]
+         */
+        virtual void getRowBits(int gy, int gxBegin, int gxEnd, uint64_t* dst) {
+            std::fill(dst, dst + (gxEnd - gxBegin + 63) / 64, 0);
+            for(int gx = gxBegin; gx < gxEnd; gx++)
+                if(getCellState(gx, gy))
+                    appendBits(dst, gx - gxBegin, 0x1, 1);
+        }
+
+        /*
+         * Sets the cells [gxBegin, gxEnd) of a row from src, the inverse of getRowBits.
+         * Cells with a set bit become alive, all others dead.
+         */
+        virtual void setRowBits(int gy, int gxBegin, int gxEnd, const uint64_t* src) {
+            for(int gx = gxBegin; gx < gxEnd; gx++) {
+                int i = gx - gxBegin;
+                if((src[i/64] >> (63 - i%64)) & 0x1)
+                    setCellState(gx, gy);
+                else
+                    unsetCellState(gx, gy);
+            }
+        }
+
+        /*
+         * Flat storage of all rows for snapshots, rowWords words per row in the named layout.
+         * Engines without such an array return nullptr and are saved through getRowBits.
+         */
+        virtual const uint64_t* getWords(std::string& layout, size_t& rowWords) { return nullptr; }
+
+        /*
+         * Replaces all cells with the words of an engine of the same layout and size,
+         * returns false if the layout does not match
+         */
+        virtual bool setWords(const std::string& layout, size_t rowWords, const uint64_t* words) { return false; }
+
+        /*
+         * False if no cell of the row changed in the last generation
+         * and it was not edited since, engines without tracking always return true
+         */
+        virtual bool rowChanged(int gy) { return true; }
+
+        /*
+         * Selects a kernel variant, only meaningful for engines with several kernels
+         */
+        virtual void setKernel(const std::string& name) { }
+
+        /*
+         * Parses a game of life pattern string
+         * where 'O' is a live cell and all other characters dead cells.
+         * The pattern is placed in the center of the universe.
+         * Such pattern can be found at:
+         * http://www.radicaleye.com/lifepage/lexicon.html
+         */
+        bool placePattern(const std::string& patternStr) {
+            char alive = 'O';
+            char dead = '.';
+
+            size_t lineLength = 0;
+            std::vector<std::string> lines {};
+
+            std::string line;
+            std::istringstream stream(patternStr);
+            while (std::getline(stream, line)) {
+                // Trim start/end
+                line.erase(line.begin(), std::find_if(line.begin(), line.end(),
+                            [](unsigned char c) { return !std::isspace(c); }));
+                line.erase(std::find_if(line.rbegin(), line.rend(), [](unsigned char c)
+                            { return !std::isspace(c); }).base(), line.end());
+
+                if(lineLength == 0)
+                    lineLength = line.length();
+
+                if(line.length() != lineLength) {
+                    error("Pasted pattern contains uneven line lengths");
+                    return false;
+                }
+
+                lines.push_back(line);
+            }
+
+            if(lines.size() > (size_t) height || lineLength > (size_t) width) {
+                error("Pasted pattern is too large for game of size", 
+                        std::to_string(width) + "x" + std::to_string(height));
+                return false;
+            }
+
+            int offsetX = (width - (int) lineLength)/2;
+            int offsetY = (height - (int) lines.size())/2;
+
+            int gx = 0;
+            int gy = 0;
+            for(size_t i = 0; i < lines.size(); i++) {
+                gx = 0;
+                for(size_t c = 0; c < lines[i].length(); c++) {
+                    if(lines[i].at(c) == alive)
+                        setCellState(offsetX + gx, offsetY + gy);
+                    else if(lines[i].at(c) == dead)
+                        unsetCellState(offsetX + gx, offsetY + gy);
+                    gx++;
+                }
+                gy++;
+            }
+
+            return true;
+        }
+
+        /*
+         * Writes the number of live cells in squares of 2^lodLog x 2^lodLog cells to dst,
+         * covering the rows [gy, gy + 2^lodLog) and the columns [gxBegin, gxEnd).
+         * The counts are taken with popcounts on the packed rows of getRowBits.
+         */
+        virtual void getDensityRow(int gy, int lodLog, int gxBegin, int gxEnd, uint32_t* dst) {
+            int lod = 1 << lodLog;
+            int squares = (gxEnd - gxBegin) >> lodLog;
+            std::fill(dst, dst + squares, 0);
+
+            std::vector<uint64_t> bits((gxEnd - gxBegin + 63) / 64);
+            for(int y = gy; y < gy + lod; y++) {
+                getRowBits(y, gxBegin, gxEnd, bits.data());
+                for(int i = 0; i < squares; i++) {
+                    if(lod >= 64) {
+                        for(int w = i * lod / 64; w < (i + 1) * lod / 64; w++)
+                            dst[i] += __builtin_popcountll(bits[w]);
+                    } else {
+                        int shift = 64 - (i * lod) % 64 - lod;
+                        dst[i] += __builtin_popcountll((bits[i * lod / 64] >> shift) & ((1ull << lod) - 1));
+                    }
+                }
+            }
+        }
+
+        /*
+         * Ors count cells (1 to 64) into the zeroed bit row dst, starting at cell pos.
+         * The cells are the lowest count bits of bits, the first cell in the highest of them.
+         */
+        static void appendBits(uint64_t* dst, int pos, uint64_t bits, int count) {
+            int offset = pos % 64;
+            uint64_t aligned = bits << (64 - count);
+            dst[pos/64] |= aligned >> offset;
+            if(offset + count > 64)
+                dst[pos/64 + 1] |= aligned << (64 - offset);
+        }
+
+        /*
+         * Returns count (1 to 64) cells of the bit row src starting at cell pos,
+         * the first cell in the highest of the lowest count bits. The inverse of appendBits.
+         */
+        static uint64_t extractBits(const uint64_t* src, int pos, int count) {
+            int offset = pos % 64;
+            uint64_t bits = src[pos/64] << offset;
+            if(offset + count > 64)
+                bits |= src[pos/64 + 1] >> (64 - offset);
+            return count == 64 ? bits : bits >> (64 - count);
+        }
+
+        /*
+         * Computes the next closest power of two
+         * More information: https://graphics.stanford.edu/%7Eseander/bithacks.html#RoundUpPowerOf2
+         */
+        static uint64_t nextPowerOfTwo(uint64_t n) {
+            n--;
+            n |= n >> 1;
+            n |= n >> 2;
+            n |= n >> 4;
+            n |= n >> 8;
+            n |= n >> 16;
+            n |= n >> 32;
+            return ++n;
+        }
+
+    protected:
+        void error(std::string msg, std::string detail = "") {
+            std::cerr << "[" << getName() << "] " << msg;
+            if(!detail.empty())
+                std::cerr << ": " << detail;
+            std::cerr << "\n";
+        }
+};
+
+#endif /* ENGINE_H */
@@ -0,0 +1,40 @@
+// 
+// engines.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef ENGINES_H
+#define ENGINES_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "bitUniverse.h"
+#include "engine.h"
+#include "hashLife.h"
+#include "planeUniverse.h"
+#include "universe.h"
+
+/*
+ * Creates the engine selected by name ("nibble", "bitboard", "hashlife", "plane"),
+ * unknown names fall back to the nibble engine.
+ * The memory limit only applies to the hashlife node table.
+ */
+inline Engine* createEngine(const std::string& name, int width, int height, size_t memoryLimitMb = 1024) {
+    if(name == "bitboard")
+        return new BitUniverse(width, height);
+    if(name == "hashlife")
+        return new HashLife(width, height, memoryLimitMb);
+    if(name == "plane")
+        return new PlaneUniverse(width, height);
+
+    if(!name.empty() && name != "nibble")
+        std::cerr << "[Engine] Unknown engine, falling back to nibble: " << name << "\n";
+
+    return new Universe(width, height);
+}
+
+#endif /* ENGINES_H */
@@ -0,0 +1,127 @@
+// 
+// glyphAtlas.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "texture.h"
+
+/*
+ * Printable ASCII of a monospace font rasterized once into a texture.
+ * Text is composed from the atlas as one quad per character and drawn in a single call,
+ * changing text costs no font rasterization, texture upload or allocation.
+ * Other characters are drawn as '?'.
+ */
+class GlyphAtlas {
+    private:
+        static const char firstGlyph = ' ';
+        static const char lastGlyph = '~';
+        static const int glyphCount = lastGlyph - firstGlyph + 1;
+
+        SDL_Renderer* renderer = nullptr;
+        Texture atlas;
+        float glyphWidth = 0;
+        float glyphHeight = 0;
+        float lineSkip = 0;
+
+        std::vector<SDL_Vertex> vertices {};
+        std::vector<int> indices {};
+
+    public:
+        GlyphAtlas() { }
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        /*
+         * The glyphs are rendered white and tinted when drawn
+         */
+        bool load(SDL_Renderer* r, TTF_Font* font) {
+            renderer = r;
+            if(font == nullptr)
+                return false;
+
+            std::string glyphs;
+            for(char c = firstGlyph; c <= lastGlyph; c++)
+                glyphs += c;
+
+            // Monospace, the glyphs of one run are evenly spaced
+            atlas.setRenderer(renderer);
+            if(!atlas.loadText(glyphs, font, {255, 255, 255}))
+                return false;
+            glyphWidth = (float) atlas.getWidth() / glyphCount;
+            glyphHeight = atlas.getHeight();
+            lineSkip = std::max((float) TTF_GetFontLineSkip(font), glyphHeight);
+            return true;
+        }
+
+        bool isLoaded() { return atlas.isLoaded(); }
+
+        float getGlyphWidth() { return glyphWidth; }
+        float getLineHeight() { return lineSkip; }
+
+        float getTextWidth(const std::string& text) {
+            size_t longest = 0;
+            size_t length = 0;
+            for(char c : text) {
+                length = c == '\n' ? 0 : length + 1;
+                longest = std::max(longest, length);
+            }
+            return longest * glyphWidth;
+        }
+
+        float getTextHeight(const std::string& text) {
+            if(text.empty())
+                return 0;
+            return (std::count(text.begin(), text.end(), '\n') + 1) * lineSkip - (lineSkip - glyphHeight);
+        }
+
+        /*
+         * Draws the text with its top left corner at x, y, '\n' starts a new line
+         */
+        void render(const std::string& text, float x, float y, SDL_Color color) {
+            if(!atlas.isLoaded())
+                return;
+
+            vertices.clear();
+            indices.clear();
+            SDL_FColor tint = {color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f};
+            float u = 1.f / glyphCount;
+            float left = x;
+            float top = y;
+            for(char c : text) {
+                if(c == '\n') {
+                    left = x;
+                    top += lineSkip;
+                    continue;
+                }
+                if(c != ' ') {
+                    int glyph = (c < firstGlyph || c > lastGlyph ? '?' : c) - firstGlyph;
+                    int first = vertices.size();
+                    vertices.push_back({{left, top}, tint, {glyph * u, 0.f}});
+                    vertices.push_back({{left + glyphWidth, top}, tint, {(glyph + 1) * u, 0.f}});
+                    vertices.push_back({{left + glyphWidth, top + glyphHeight}, tint, {(glyph + 1) * u, 1.f}});
+                    vertices.push_back({{left, top + glyphHeight}, tint, {glyph * u, 1.f}});
+                    for(int i : {0, 1, 2, 0, 2, 3})
+                        indices.push_back(first + i);
+                }
+                left += glyphWidth;
+            }
+
+            if(!indices.empty())
+                SDL_RenderGeometry(renderer, atlas.getTexture(), vertices.data(), vertices.size(),
+                        indices.data(), indices.size());
+        }
+};
+
+#endif /* GLYPHATLAS_H */
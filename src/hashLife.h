@@ -0,0 +1,531 @@
+// 
+// hashLife.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+#include "threadPool.h"
+
+/*
+ * Quadtree node, level 0 nodes are single cells.
+ * A node of level L covers 2^L x 2^L cells, result caches
+ * the center 2^(L-1) x 2^(L-1) cells advanced by the current step.
+ */
+struct HashNode {
+    HashNode* nw;
+    HashNode* ne;
+    HashNode* sw;
+    HashNode* se;
+    HashNode* result;
+    HashNode* hashNext;
+    uint64_t population;
+    int level;
+    bool marked;
+};
+
+/*
+ * HashLife engine, memoized quadtree algorithm described in section 3 of:
+ * https://www.gathering4gardner.org/g4g13gift/math/RokickiTomas-GiftExchange-LifeAlgorithms-G4G13.pdf
+ *
+ * All nodes are canonical (hash consed), so identical regions are only stored
+ * and computed once. The torus is simulated by tiling a node of twice the
+ * universe size with the universe shifted by half its size, the center of
+ * the result is then the whole torus again.
+ * The universe is always a square with a power of two side length,
+ * other sizes are rounded up.
+ */
+class HashLife : public Engine {
+    private:
+        const int rootLevel;
+
+        HashNode deadLeaf;
+        HashNode aliveLeaf;
+        HashNode* root = nullptr;
+        std::vector<HashNode*> emptyNodes {};
+
+        std::vector<HashNode*> buckets {};
+        size_t nodeCount = 0;
+        size_t peakNodeCount = 0;
+        size_t maxNodes = 0;
+
+        // Headroom for the nodes a root step still creates after running out of nodes
+        size_t nodeReserve = 0;
+        bool limitNodes = true;
+        bool outOfNodes = false;
+        bool limitWarned = false;
+
+        // log2 of the generations result() advances, results are only valid for this step
+        int stepLog = -1;
+
+    public:
+        HashLife(int width, int height, size_t memoryLimitMb = 1024) :
+        Engine(squareSize(width, height), squareSize(width, height)),
+        rootLevel(__builtin_ctzll(this->width)) {
+            if(width != this->width || height != this->height)
+                error("Universe rounded up to a power of two square", 
+                        std::to_string(this->width) + "x" + std::to_string(this->height));
+
+            deadLeaf = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0, true};
+            aliveLeaf = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 1, 0, true};
+
+            maxNodes = memoryLimitMb * 1024 * 1024 / (sizeof(HashNode) + 2 * sizeof(HashNode*));
+            nodeReserve = 16 * (rootLevel + 2);
+            buckets = std::vector<HashNode*>(1 << 16, nullptr);
+
+            root = emptyNode(rootLevel);
+        }
+
+        ~HashLife() {
+            for(HashNode* bucket : buckets) {
+                while(bucket != nullptr) {
+                    HashNode* next = bucket->hashNext;
+                    delete bucket;
+                    bucket = next;
+                }
+            }
+        }
+
+        std::string getName() { return "hashlife"; }
+
+        static int squareSize(int width, int height) {
+            return std::max(nextPowerOfTwo(std::max(width, height)), (uint64_t) 16);
+        }
+
+        size_t getNodeCount() { return nodeCount; }
+
+        size_t getPeakNodeCount() { return peakNodeCount; }
+
+        size_t getMaxNodes() { return maxNodes; }
+
+        void step(ThreadPool* pool = nullptr) {
+            stepPowerOfTwo(0, pool);
+        }
+
+        /*
+         * Advances the torus by 2^log2Generations in root steps of at most half the universe size.
+         * A root step that runs out of nodes is abandoned, retried once after the garbage
+         * collection and then split into two steps, so the node count stays below maxNodes.
+         */
+        void stepPowerOfTwo(int log2Generations, ThreadPool* pool = nullptr) {
+            long remaining = 1L << log2Generations;
+            int log = std::min(log2Generations, rootLevel - 1);
+
+            if(log != stepLog) {
+                clearResults();
+                stepLog = log;
+            }
+
+            bool retried = false;
+            while(remaining > 0) {
+                if(nodeCount + nodeReserve > maxNodes)
+                    collectGarbage();
+
+                outOfNodes = false;
+                HashNode* next = stepRoot();
+                if(!outOfNodes) {
+                    root = next;
+                    generation += 1L << log;
+                    remaining -= 1L << log;
+                    retried = false;
+                    continue;
+                }
+
+                collectGarbage();
+                if(!retried) {
+                    retried = true;
+                    continue;
+                }
+
+                if(log > 0) {
+                    log--;
+                    clearResults();
+                    stepLog = log;
+                    continue;
+                }
+
+                // Not even a single generation fits, the limit is lifted for the rest of this jump
+                if(!limitWarned)
+                    error("Memory limit too small for one generation", std::to_string(maxNodes) + " nodes");
+                limitWarned = true;
+                limitNodes = false;
+            }
+            limitNodes = true;
+        }
+
+        bool hasNativeJump() { return true; }
+
+        /*
+         * A jump takes 2^(log2Generations - rootLevel + 1) root steps, at most 2^16
+         */
+        int getMaxJumpLog() { return std::min(rootLevel - 1 + 16, 40); }
+
+        void initGolRandom() {
+            generation = 0;
+            std::vector<bool> alive((size_t) width * height);
+            for(size_t i = 0; i < alive.size(); i++)
+                alive[i] = rand() % 3 < 1;
+
+            root = build(rootLevel, 0, 0, alive);
+        }
+
+        void initGolClear() {
+            generation = 0;
+            root = emptyNode(rootLevel);
+        }
+
+        void initGolFull() {
+            generation = 0;
+            HashNode* full = &aliveLeaf;
+            for(int level = 1; level <= rootLevel; level++)
+                full = getNode(full, full, full, full);
+            root = full;
+        }
+
+        uint64_t population() { return root->population; }
+
+        bool getCellState(int gx, int gy) {
+            HashNode* n = root;
+            for(int level = rootLevel; level > 0; level--) {
+                int half = 1 << (level - 1);
+                bool east = gx & half;
+                bool south = gy & half;
+                n = south ? (east ? n->se : n->sw) : (east ? n->ne : n->nw);
+            }
+            return n == &aliveLeaf;
+        }
+
+        void setCellState(int gx, int gy) {
+            root = setCell(root, gx, gy, true);
+        }
+
+        void unsetCellState(int gx, int gy) {
+            root = setCell(root, gx, gy, false);
+        }
+
+        void getRowBits(int gy, int gxBegin, int gxEnd, uint64_t* dst) {
+            std::fill(dst, dst + (gxEnd - gxBegin + 63) / 64, 0);
+            rowBits(root, gy, gxBegin, gxEnd, dst, 0);
+        }
+
+        /*
+         * Squares aligned to their size are nodes, their population is already known
+         */
+        void getDensityRow(int gy, int lodLog, int gxBegin, int gxEnd, uint32_t* dst) {
+            int lod = 1 << lodLog;
+            if(gy % lod != 0 || gxBegin % lod != 0 || gxEnd % lod != 0) {
+                Engine::getDensityRow(gy, lodLog, gxBegin, gxEnd, dst);
+                return;
+            }
+
+            std::fill(dst, dst + ((gxEnd - gxBegin) >> lodLog), 0);
+            densityRow(root, gy, gxBegin, gxEnd, lodLog, dst);
+        }
+
+    private:
+        HashNode* getNode(HashNode* nw, HashNode* ne, HashNode* sw, HashNode* se) {
+            size_t index = hash(nw, ne, sw, se) & (buckets.size() - 1);
+            for(HashNode* n = buckets[index]; n != nullptr; n = n->hashNext) {
+                if(n->nw == nw && n->ne == ne && n->sw == sw && n->se == se)
+                    return n;
+            }
+
+            HashNode* n = new HashNode {nw, ne, sw, se, nullptr, buckets[index],
+                nw->population + ne->population + sw->population + se->population,
+                nw->level + 1, false};
+            buckets[index] = n;
+            nodeCount++;
+            peakNodeCount = std::max(peakNodeCount, nodeCount);
+
+            if(limitNodes && nodeCount + nodeReserve >= maxNodes)
+                outOfNodes = true;
+
+            if(nodeCount > buckets.size())
+                resize(buckets.size() * 2);
+
+            return n;
+        }
+
+        static size_t hash(HashNode* nw, HashNode* ne, HashNode* sw, HashNode* se) {
+            uint64_t h = (uintptr_t) nw;
+            h = h * 0x9E3779B97F4A7C15ull + (uintptr_t) ne;
+            h = h * 0x9E3779B97F4A7C15ull + (uintptr_t) sw;
+            h = h * 0x9E3779B97F4A7C15ull + (uintptr_t) se;
+            return h ^ (h >> 29);
+        }
+
+        void resize(size_t size) {
+            std::vector<HashNode*> resized(size, nullptr);
+            for(HashNode* bucket : buckets) {
+                while(bucket != nullptr) {
+                    HashNode* next = bucket->hashNext;
+                    size_t index = hash(bucket->nw, bucket->ne, bucket->sw, bucket->se) & (size - 1);
+                    bucket->hashNext = resized[index];
+                    resized[index] = bucket;
+                    bucket = next;
+                }
+            }
+            buckets.swap(resized);
+        }
+
+        HashNode* emptyNode(int level) {
+            if(emptyNodes.empty())
+                emptyNodes.push_back(&deadLeaf);
+            while(emptyNodes.size() <= (size_t) level) {
+                HashNode* e = emptyNodes.back();
+                emptyNodes.push_back(getNode(e, e, e, e));
+            }
+            return emptyNodes[level];
+        }
+
+        HashNode* build(int level, int x, int y, const std::vector<bool>& alive) {
+            if(level == 0)
+                return alive[x + (size_t) y * width] ? &aliveLeaf : &deadLeaf;
+
+            int half = 1 << (level - 1);
+            return getNode(
+                    build(level - 1, x,        y,        alive),
+                    build(level - 1, x + half, y,        alive),
+                    build(level - 1, x,        y + half, alive),
+                    build(level - 1, x + half, y + half, alive));
+        }
+
+        HashNode* setCell(HashNode* n, int gx, int gy, bool alive) {
+            if(n->level == 0)
+                return alive ? &aliveLeaf : &deadLeaf;
+
+            int half = 1 << (n->level - 1);
+            bool east = gx & half;
+            bool south = gy & half;
+            gx &= half - 1;
+            gy &= half - 1;
+
+            if(!south && !east) return getNode(setCell(n->nw, gx, gy, alive), n->ne, n->sw, n->se);
+            if(!south &&  east) return getNode(n->nw, setCell(n->ne, gx, gy, alive), n->sw, n->se);
+            if( south && !east) return getNode(n->nw, n->ne, setCell(n->sw, gx, gy, alive), n->se);
+            return getNode(n->nw, n->ne, n->sw, setCell(n->se, gx, gy, alive));
+        }
+
+        /*
+         * Writes the populations of the level lodLog nodes in the columns [gxBegin, gxEnd) 
+         * of row gy of node n, coordinates relative to the node and multiples of 2^lodLog
+         */
+        void densityRow(HashNode* n, int gy, int gxBegin, int gxEnd, int lodLog, uint32_t* dst) {
+            int size = 1 << n->level;
+            if(n->population == 0)
+                return;
+
+            if(n->level == lodLog) {
+                dst[0] = n->population;
+                return;
+            }
+
+            if(n->population == (uint64_t) size * size) {
+                std::fill(dst, dst + ((gxEnd - gxBegin) >> lodLog), 1u << (2 * lodLog));
+                return;
+            }
+
+            int half = size / 2;
+            HashNode* west = gy < half ? n->nw : n->sw;
+            HashNode* east = gy < half ? n->ne : n->se;
+            int y = gy < half ? gy : gy - half;
+            if(gxBegin < half)
+                densityRow(west, y, gxBegin, std::min(gxEnd, half), lodLog, dst);
+            if(gxEnd > half)
+                densityRow(east, y, std::max(gxBegin, half) - half, gxEnd - half, lodLog,
+                        dst + (std::max(0, half - gxBegin) >> lodLog));
+        }
+
+        /*
+         * Sets the bits of the live cells [gxBegin, gxEnd) of row gy of node n 
+         * starting at bit pos of dst, coordinates relative to the node
+         */
+        void rowBits(HashNode* n, int gy, int gxBegin, int gxEnd, uint64_t* dst, int pos) {
+            int size = 1 << n->level;
+            if(n->population == 0)
+                return;
+
+            if(n->population == (uint64_t) size * size) {
+                for(int x = gxBegin; x < gxEnd; x += 64) {
+                    int count = std::min(gxEnd - x, 64);
+                    appendBits(dst, pos + (x - gxBegin), count == 64 ? ~0ull : (1ull << count) - 1, count);
+                }
+                return;
+            }
+
+            int half = size / 2;
+            HashNode* west = gy < half ? n->nw : n->sw;
+            HashNode* east = gy < half ? n->ne : n->se;
+            int y = gy < half ? gy : gy - half;
+            if(gxBegin < half)
+                rowBits(west, y, gxBegin, std::min(gxEnd, half), dst, pos);
+            if(gxEnd > half)
+                rowBits(east, y, std::max(gxBegin, half) - half, gxEnd - half, 
+                        dst, pos + std::max(0, half - gxBegin));
+        }
+
+        /*
+         * Advances the center 2x2 cells of a 4x4 node by one generation
+         */
+        HashNode* baseResult(HashNode* n) {
+            bool cells[4][4];
+            HashNode* quadrants[2][2] = {{n->nw, n->ne}, {n->sw, n->se}};
+            for(int qy = 0; qy < 2; qy++) {
+                for(int qx = 0; qx < 2; qx++) {
+                    HashNode* q = quadrants[qy][qx];
+                    cells[qy*2    ][qx*2    ] = q->nw == &aliveLeaf;
+                    cells[qy*2    ][qx*2 + 1] = q->ne == &aliveLeaf;
+                    cells[qy*2 + 1][qx*2    ] = q->sw == &aliveLeaf;
+                    cells[qy*2 + 1][qx*2 + 1] = q->se == &aliveLeaf;
+                }
+            }
+
+            HashNode* next[2][2];
+            for(int y = 1; y <= 2; y++) {
+                for(int x = 1; x <= 2; x++) {
+                    int count = 0;
+                    for(int dy = -1; dy <= 1; dy++)
+                        for(int dx = -1; dx <= 1; dx++)
+                            count += (dx != 0 || dy != 0) && cells[y + dy][x + dx];
+                    bool alive = count == 3 || (count == 2 && cells[y][x]);
+                    next[y-1][x-1] = alive ? &aliveLeaf : &deadLeaf;
+                }
+            }
+
+            return getNode(next[0][0], next[0][1], next[1][0], next[1][1]);
+        }
+
+        HashNode* centeredSubnode(HashNode* n) {
+            return getNode(n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+        }
+
+        /*
+         * The whole torus advanced by 2^stepLog generations
+         */
+        HashNode* stepRoot() {
+            HashNode* shifted = getNode(root->se, root->sw, root->ne, root->nw);
+            HashNode* tiled = getNode(shifted, shifted, shifted, shifted);
+            return result(tiled);
+        }
+
+        /*
+         * Center of a node of level L advanced by 2^stepLog generations,
+         * stepLog must be at most L-2. At stepLog == L-2 both stages
+         * advance time, otherwise the first stage only recenters.
+         * Once out of nodes the step is abandoned, the returned nodes
+         * are wrong and nothing more is cached.
+         */
+        HashNode* result(HashNode* n) {
+            if(n->result != nullptr)
+                return n->result;
+
+            if(outOfNodes)
+                return n->nw;
+
+            if(n->population == 0) {
+                n->result = n->nw;
+                return n->result;
+            }
+
+            if(n->level == 2) {
+                n->result = baseResult(n);
+                return n->result;
+            }
+
+            HashNode* n00 = n->nw;
+            HashNode* n01 = getNode(n->nw->ne, n->ne->nw, n->nw->se, n->ne->sw);
+            HashNode* n02 = n->ne;
+            HashNode* n10 = getNode(n->nw->sw, n->nw->se, n->sw->nw, n->sw->ne);
+            HashNode* n11 = centeredSubnode(n);
+            HashNode* n12 = getNode(n->ne->sw, n->ne->se, n->se->nw, n->se->ne);
+            HashNode* n20 = n->sw;
+            HashNode* n21 = getNode(n->sw->ne, n->se->nw, n->sw->se, n->se->sw);
+            HashNode* n22 = n->se;
+
+            HashNode* r[3][3];
+            HashNode* sub[3][3] = {{n00, n01, n02}, {n10, n11, n12}, {n20, n21, n22}};
+            bool fullSpeed = stepLog >= n->level - 2;
+            for(int y = 0; y < 3; y++)
+                for(int x = 0; x < 3; x++)
+                    r[y][x] = fullSpeed ? result(sub[y][x]) : centeredSubnode(sub[y][x]);
+            if(outOfNodes)
+                return n->nw;
+
+            HashNode* next = getNode(
+                    result(getNode(r[0][0], r[0][1], r[1][0], r[1][1])),
+                    result(getNode(r[0][1], r[0][2], r[1][1], r[1][2])),
+                    result(getNode(r[1][0], r[1][1], r[2][0], r[2][1])),
+                    result(getNode(r[1][1], r[1][2], r[2][1], r[2][2])));
+            if(!outOfNodes)
+                n->result = next;
+            return next;
+        }
+
+        void clearResults() {
+            for(HashNode* bucket : buckets)
+                for(HashNode* n = bucket; n != nullptr; n = n->hashNext)
+                    n->result = nullptr;
+        }
+
+        void mark(HashNode* n, bool withResults) {
+            if(n->marked)
+                return;
+            n->marked = true;
+            mark(n->nw, withResults);
+            mark(n->ne, withResults);
+            mark(n->sw, withResults);
+            mark(n->se, withResults);
+            if(withResults && n->result != nullptr)
+                mark(n->result, withResults);
+        }
+
+        void sweep() {
+            for(HashNode*& bucket : buckets) {
+                HashNode** link = &bucket;
+                while(*link != nullptr) {
+                    HashNode* n = *link;
+                    if(n->marked) {
+                        n->marked = false;
+                        link = &n->hashNext;
+                    } else {
+                        *link = n->hashNext;
+                        delete n;
+                        nodeCount--;
+                    }
+                }
+            }
+        }
+
+        /*
+         * Frees all nodes that are not reachable from the root.
+         * Cached results are kept if that frees enough memory,
+         * otherwise they are dropped as well.
+         */
+        void collectGarbage() {
+            markRoots(true);
+            sweep();
+
+            if(nodeCount > maxNodes / 2) {
+                clearResults();
+                markRoots(false);
+                sweep();
+            }
+        }
+
+        void markRoots(bool withResults) {
+            mark(root, withResults);
+            for(HashNode* e : emptyNodes)
+                mark(e, withResults);
+        }
+};
+
+#endif /* HASHLIFE_H */
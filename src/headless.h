@@ -0,0 +1,151 @@
+// 
+// headless.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "patternIO.h"
+#include "patterns.h"
+#include "snapshot.h"
+#include "timer.h"
+#include "engines.h"
+
+struct HeadlessOptions {
+    int width = 100;
+    int height = 100;
+    long generations = 1000;
+    unsigned int seed = 0;
+    std::string patternPath = "";
+    int patternId = 0;
+    std::string savePath = "";
+    std::string snapshotPath = "";
+    std::string restorePath = "";
+    long checkpointGenerations = 0;
+    int threads = 0;
+    std::string kernel = "";
+    std::string engine = "";
+    int stepLog = 0;
+    size_t memoryLimitMb = 1024;
+};
+
+/*
+ * Runs the simulation without window, fonts or vsync
+ * and reports the throughput once all generations are computed.
+ */
+class HeadlessRunner {
+    private:
+        HeadlessOptions options;
+        Engine* engine;
+        ThreadPool threadPool;
+        SnapshotWriter snapshotWriter;
+        Timer stepTimer;
+        Histogram stepHistogram;
+
+    public:
+        HeadlessRunner(const HeadlessOptions& options) : options(options), 
+        engine(createEngine(options.engine, options.width, options.height, options.memoryLimitMb)), 
+        threadPool(options.threads) { }
+
+        ~HeadlessRunner() {
+            delete engine;
+        }
+
+        int run() {
+            engine->setKernel(options.kernel);
+            if(!initUniverse())
+                return 1;
+            // Restored and #G generations are not part of the throughput
+            long startGeneration = engine->generation;
+
+            Timer timer;
+            timer.start();
+            long stepSize = 1L << options.stepLog;
+            long lastCheckpoint = engine->generation;
+            for(long g = 0; g < options.generations; g += stepSize) {
+                stepTimer.start();
+                engine->stepPowerOfTwo(options.stepLog, &threadPool);
+                stepTimer.stop();
+                stepHistogram.record(stepTimer.getNs());
+
+                // Written in the background while the run continues, deferred while the last one is still written
+                if(options.checkpointGenerations > 0 && !options.snapshotPath.empty()
+                        && engine->generation - lastCheckpoint >= options.checkpointGenerations
+                        && !snapshotWriter.isWriting()) {
+                    snapshotWriter.save(engine, options.snapshotPath);
+                    lastCheckpoint = engine->generation;
+                }
+            }
+            timer.stop();
+
+            report(timer.getNs(), startGeneration);
+
+            if(!options.snapshotPath.empty()) {
+                snapshotWriter.wait();
+                snapshotWriter.save(engine, options.snapshotPath);
+                snapshotWriter.wait();
+            }
+
+            if(!options.savePath.empty() && !savePattern(options.savePath, engine))
+                return 1;
+            return 0;
+        }
+
+    private:
+        bool initUniverse() {
+            if(!options.restorePath.empty())
+                return loadSnapshot(options.restorePath, engine);
+
+            if(options.patternPath.empty()) {
+                srand(options.seed);
+                engine->initGolRandom();
+                return true;
+            }
+
+            if(isRleOrMacrocell(options.patternPath)) {
+                engine->initGolClear();
+                return loadPattern(options.patternPath, engine);
+            }
+
+            std::vector<std::string> patterns {};
+            if(!loadPatternFile(options.patternPath, patterns))
+                return false;
+
+            if(options.patternId < 0 || (size_t) options.patternId >= patterns.size()) {
+                std::cerr << "[Headless] Invalid pattern id: " << options.patternId << "\n";
+                return false;
+            }
+
+            engine->initGolClear();
+            return engine->placePattern(patterns[options.patternId]);
+        }
+
+        void report(long ns, long startGeneration) {
+            double seconds = ns / 1e9;
+            long generations = engine->generation - startGeneration;
+            double cellUpdates = (double) engine->width * engine->height * generations;
+
+            std::cout << "size:           " << engine->width << "x" << engine->height << "\n"
+                << "generations:    " << generations << "\n"
+                << "threads:        " << threadPool.size() << "\n"
+                << "engine:         " << engine->getName() << "\n"
+                << "population:     " << engine->population() << "\n"
+                << std::fixed << std::setprecision(3)
+                << "time:           " << seconds << " s\n"
+                << "gens/sec:       " << generations / seconds << "\n"
+                << std::scientific << std::setprecision(3)
+                << "cell-updates/s: " << cellUpdates / seconds << "\n"
+                << "step times:     " << stepHistogram.toString() << "\n";
+        }
+};
+
+#endif /* HEADLESS_H */
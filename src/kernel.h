@@ -0,0 +1,251 @@
+// 
+// kernel.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNEL_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * Row kernels compute the next state of a row of 16 cell blocks,
+ * north and south are the wrapped neighbouring rows. The row is split into tiles of
+ * tileBlocks blocks (the last one possibly shorter), only tiles flagged in activeTiles
+ * are computed and changedTiles is set for every tile in which a cell changed.
+ */
+typedef void (*RowKernelFn)(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength,
+        int tileBlocks, const uint8_t* activeTiles, uint8_t* changedTiles);
+
+struct RowKernel {
+    const char* name;
+    RowKernelFn fn;
+};
+
+/*
+ * More information about this algorithm, see section 2.4 of:
+ * https://www.gathering4gardner.org/g4g13gift/math/RokickiTomas-GiftExchange-LifeAlgorithms-G4G13.pdf
+ * */
+inline uint64_t nextBlock(uint64_t c,
+        uint64_t nw, uint64_t n, uint64_t ne,
+        uint64_t w, uint64_t e,
+        uint64_t sw, uint64_t s, uint64_t se,
+        uint64_t& r) {
+    r = (c << 4) + (c >> 4)
+        + (n  << 4) + n + (n  >> 4)
+        + (s  << 4) + s + (s  >> 4)
+        + (nw << 60)  +   (ne >> 60)
+        + (w  << 60)  +   (e  >> 60)
+        + (sw << 60)  +   (se >> 60);
+
+    return (r | c)
+        & (r >> 1) & ~(r >> 2) & ~(r >> 3)
+        & 0x1111111111111111;
+}
+
+inline uint64_t nextBlockScalar(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength, int x) {
+    int nC = (x + 1) >= rowLength ?           0 : x+1;
+    int pC = (x - 1) <          0 ? rowLength-1 : x-1;
+
+    // The neighbour counts are not stored, they are only needed for display and recomputed there
+    uint64_t r;
+    swapRow[x] = nextBlock(row[x],
+            north[pC], north[x], north[nC],
+            row[pC], row[nC],
+            south[pC], south[x], south[nC],
+            r);
+    return swapRow[x] ^ row[x];
+}
+
+/*
+ * Computes the blocks [xBegin, xEnd), returns the bitwise or of all changed cells
+ */
+inline uint64_t nextSegmentScalar(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength, int xBegin, int xEnd) {
+    uint64_t changed = 0;
+    for(int x = xBegin; x < xEnd; x++)
+        changed |= nextBlockScalar(north, row, south, swapRow, rowLength, x);
+    return changed;
+}
+
+inline void nextRowScalar(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength,
+        int tileBlocks, const uint8_t* activeTiles, uint8_t* changedTiles) {
+    for(int t = 0; t * tileBlocks < rowLength; t++) {
+        if(activeTiles[t])
+            changedTiles[t] |= nextSegmentScalar(north, row, south, swapRow, 
+                    rowLength, t * tileBlocks, std::min((t + 1) * tileBlocks, rowLength)) != 0;
+    }
+}
+
+#ifdef KERNEL_X86
+
+/*
+ * Same nibble counter scheme as nextBlock on 4 adjacent blocks per iteration.
+ * The first and last block of a row wrap around and are left to the scalar path.
+ */
+__attribute__((target("avx2")))
+inline uint64_t nextSegmentAvx2(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength, int xBegin, int xEnd) {
+    uint64_t changed = 0;
+    int x = xBegin;
+    if(x == 0)
+        changed |= nextBlockScalar(north, row, south, swapRow, rowLength, x++);
+
+    const __m256i mask = _mm256_set1_epi64x(0x1111111111111111);
+    __m256i diff = _mm256_setzero_si256();
+    int vectorEnd = std::min(xEnd, rowLength - 1);
+    for(; x + 4 <= vectorEnd; x += 4) {
+        __m256i c  = _mm256_loadu_si256((const __m256i*) (row + x));
+        __m256i w  = _mm256_loadu_si256((const __m256i*) (row + x - 1));
+        __m256i e  = _mm256_loadu_si256((const __m256i*) (row + x + 1));
+        __m256i n  = _mm256_loadu_si256((const __m256i*) (north + x));
+        __m256i nw = _mm256_loadu_si256((const __m256i*) (north + x - 1));
+        __m256i ne = _mm256_loadu_si256((const __m256i*) (north + x + 1));
+        __m256i s  = _mm256_loadu_si256((const __m256i*) (south + x));
+        __m256i sw = _mm256_loadu_si256((const __m256i*) (south + x - 1));
+        __m256i se = _mm256_loadu_si256((const __m256i*) (south + x + 1));
+
+        __m256i r = _mm256_add_epi64(_mm256_slli_epi64(c, 4), _mm256_srli_epi64(c, 4));
+        r = _mm256_add_epi64(r, _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(n, 4), n), _mm256_srli_epi64(n, 4)));
+        r = _mm256_add_epi64(r, _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(s, 4), s), _mm256_srli_epi64(s, 4)));
+        r = _mm256_add_epi64(r, _mm256_add_epi64(_mm256_slli_epi64(nw, 60), _mm256_srli_epi64(ne, 60)));
+        r = _mm256_add_epi64(r, _mm256_add_epi64(_mm256_slli_epi64(w, 60), _mm256_srli_epi64(e, 60)));
+        r = _mm256_add_epi64(r, _mm256_add_epi64(_mm256_slli_epi64(sw, 60), _mm256_srli_epi64(se, 60)));
+
+        __m256i next = _mm256_and_si256(_mm256_or_si256(r, c), _mm256_srli_epi64(r, 1));
+        next = _mm256_andnot_si256(_mm256_srli_epi64(r, 2), next);
+        next = _mm256_andnot_si256(_mm256_srli_epi64(r, 3), next);
+        next = _mm256_and_si256(next, mask);
+
+        _mm256_storeu_si256((__m256i*) (swapRow + x), next);
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(next, c));
+    }
+
+    for(; x < xEnd; x++)
+        changed |= nextBlockScalar(north, row, south, swapRow, rowLength, x);
+
+    return changed | !_mm256_testz_si256(diff, diff);
+}
+
+__attribute__((target("avx2")))
+inline void nextRowAvx2(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength,
+        int tileBlocks, const uint8_t* activeTiles, uint8_t* changedTiles) {
+    for(int t = 0; t * tileBlocks < rowLength; t++) {
+        if(activeTiles[t])
+            changedTiles[t] |= nextSegmentAvx2(north, row, south, swapRow, 
+                    rowLength, t * tileBlocks, std::min((t + 1) * tileBlocks, rowLength)) != 0;
+    }
+}
+
+/*
+ * Zero masked forms of the AVX-512 shifts and andnot. The plain intrinsics pass an undefined
+ * source vector to the masked builtins, which gcc reports as maybe uninitialized.
+ */
+template<unsigned int n>
+__attribute__((target("avx512f")))
+inline __m512i shiftLeft512(__m512i v) { return _mm512_maskz_slli_epi64((__mmask8) 0xFF, v, n); }
+
+template<unsigned int n>
+__attribute__((target("avx512f")))
+inline __m512i shiftRight512(__m512i v) { return _mm512_maskz_srli_epi64((__mmask8) 0xFF, v, n); }
+
+__attribute__((target("avx512f")))
+inline __m512i andNot512(__m512i a, __m512i b) { return _mm512_maskz_andnot_epi64((__mmask8) 0xFF, a, b); }
+
+/*
+ * AVX-512 variant of nextSegmentAvx2 with 8 blocks per iteration.
+ */
+__attribute__((target("avx512f")))
+inline uint64_t nextSegmentAvx512(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength, int xBegin, int xEnd) {
+    uint64_t changed = 0;
+    int x = xBegin;
+    if(x == 0)
+        changed |= nextBlockScalar(north, row, south, swapRow, rowLength, x++);
+
+    const __m512i mask = _mm512_set1_epi64(0x1111111111111111);
+    __m512i diff = _mm512_setzero_si512();
+    int vectorEnd = std::min(xEnd, rowLength - 1);
+    for(; x + 8 <= vectorEnd; x += 8) {
+        __m512i c  = _mm512_loadu_si512(row + x);
+        __m512i w  = _mm512_loadu_si512(row + x - 1);
+        __m512i e  = _mm512_loadu_si512(row + x + 1);
+        __m512i n  = _mm512_loadu_si512(north + x);
+        __m512i nw = _mm512_loadu_si512(north + x - 1);
+        __m512i ne = _mm512_loadu_si512(north + x + 1);
+        __m512i s  = _mm512_loadu_si512(south + x);
+        __m512i sw = _mm512_loadu_si512(south + x - 1);
+        __m512i se = _mm512_loadu_si512(south + x + 1);
+
+        __m512i r = _mm512_add_epi64(shiftLeft512<4>(c), shiftRight512<4>(c));
+        r = _mm512_add_epi64(r, _mm512_add_epi64(_mm512_add_epi64(shiftLeft512<4>(n), n), shiftRight512<4>(n)));
+        r = _mm512_add_epi64(r, _mm512_add_epi64(_mm512_add_epi64(shiftLeft512<4>(s), s), shiftRight512<4>(s)));
+        r = _mm512_add_epi64(r, _mm512_add_epi64(shiftLeft512<60>(nw), shiftRight512<60>(ne)));
+        r = _mm512_add_epi64(r, _mm512_add_epi64(shiftLeft512<60>(w), shiftRight512<60>(e)));
+        r = _mm512_add_epi64(r, _mm512_add_epi64(shiftLeft512<60>(sw), shiftRight512<60>(se)));
+
+        __m512i next = _mm512_and_si512(_mm512_or_si512(r, c), shiftRight512<1>(r));
+        next = andNot512(shiftRight512<2>(r), next);
+        next = andNot512(shiftRight512<3>(r), next);
+        next = _mm512_and_si512(next, mask);
+
+        _mm512_storeu_si512(swapRow + x, next);
+        diff = _mm512_or_si512(diff, _mm512_xor_si512(next, c));
+    }
+
+    for(; x < xEnd; x++)
+        changed |= nextBlockScalar(north, row, south, swapRow, rowLength, x);
+
+    return changed | (_mm512_test_epi64_mask(diff, diff) != 0);
+}
+
+__attribute__((target("avx512f")))
+inline void nextRowAvx512(const uint64_t* north, const uint64_t* row, const uint64_t* south,
+        uint64_t* swapRow, int rowLength,
+        int tileBlocks, const uint8_t* activeTiles, uint8_t* changedTiles) {
+    for(int t = 0; t * tileBlocks < rowLength; t++) {
+        if(activeTiles[t])
+            changedTiles[t] |= nextSegmentAvx512(north, row, south, swapRow, 
+                    rowLength, t * tileBlocks, std::min((t + 1) * tileBlocks, rowLength)) != 0;
+    }
+}
+
+#endif /* KERNEL_X86 */
+
+/*
+ * Picks the widest row kernel supported by the cpu.
+ * A preferred kernel ("scalar", "avx2", "avx512") is used if the cpu supports it.
+ */
+inline RowKernel selectRowKernel(const std::string& preferred = "") {
+    RowKernel scalar = {"scalar", nextRowScalar};
+    if(preferred == "scalar")
+        return scalar;
+
+#ifdef KERNEL_X86
+    __builtin_cpu_init();
+    bool hasAvx512 = __builtin_cpu_supports("avx512f");
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+
+    if(hasAvx512 && (preferred.empty() || preferred == "avx512"))
+        return {"avx512", nextRowAvx512};
+    if(hasAvx2 && (preferred.empty() || preferred == "avx2" || preferred == "avx512"))
+        return {"avx2", nextRowAvx2};
+#endif
+
+    return scalar;
+}
+
+#endif /* KERNEL_H */
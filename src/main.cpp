@@ -5,16 +5,129 @@
 // Noah Hitz 2025
 // 
 
+#include "conformance.h"
 #include "conwayApp.h"
+#include "headless.h"
+
+void usage(const char* name) {
+    std::cerr << "Usage: " << name << " [size]\n"
+        << "       " << name << " --headless [--size N] [--gens G] [--seed S] [--pattern file] [--pattern-id I]\n"
+        << "       " << name << " --verify [--gens G] [--seed S] [--engine E]   compare the engines with a reference\n"
+        << "Options: --width W, --height H   rectangular universe, any size (default: size x size)\n"
+        << "         --threads T   number of simulation threads (default: all cores)\n"
+        << "         --kernel K    scalar, avx2 or avx512 (default: widest supported)\n"
+        << "         --engine E    nibble, bitboard, hashlife or plane (default: nibble)\n"
+        << "         --hashlife-mb M   node memory limit of the hashlife engine (default: 1024)\n"
+        << "         --step-log K  headless: advance 2^K generations per step (default: 0)\n"
+        << "         --pattern F   also in windowed mode, .rle and .mc files are streamed into the universe\n"
+        << "         --save F      headless: write the final generation as .rle or .mc\n"
+        << "         --snapshot F  binary snapshot file, written at the end of a headless run or with ctrl-s\n"
+        << "         --checkpoint-gens N   headless: also write the snapshot every N generations\n"
+        << "         --restore F   continue from a snapshot, the universe takes the snapshot's size\n"
+        << "         --trace F     record a Chrome trace of frames and generations, written on exit or with ctrl-t\n";
+}
 
 int main (int argc, char *argv[]) {
-    int size = 100;
-    if(argc >= 2) {
-        size = std::stoi(std::string(argv[1]));
+    int width = 100;
+    int height = 100;
+    int threads = 0;
+    std::string kernel = "";
+    std::string engine = "";
+    size_t memoryLimitMb = 1024;
+    bool headless = false;
+    bool verify = false;
+    std::string tracePath = "";
+    HeadlessOptions options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+
+        if(arg == "--headless") {
+            headless = true;
+        } else if(arg == "--verify") {
+            verify = true;
+        } else if(arg == "--size" && hasValue) {
+            width = height = std::stoi(argv[++i]);
+        } else if(arg == "--width" && hasValue) {
+            width = std::stoi(argv[++i]);
+        } else if(arg == "--height" && hasValue) {
+            height = std::stoi(argv[++i]);
+        } else if(arg == "--gens" && hasValue) {
+            options.generations = std::stol(argv[++i]);
+        } else if(arg == "--seed" && hasValue) {
+            options.seed = std::stoul(argv[++i]);
+        } else if(arg == "--pattern" && hasValue) {
+            options.patternPath = argv[++i];
+        } else if(arg == "--threads" && hasValue) {
+            threads = std::stoi(argv[++i]);
+        } else if(arg == "--kernel" && hasValue) {
+            kernel = argv[++i];
+        } else if(arg == "--engine" && hasValue) {
+            engine = argv[++i];
+        } else if(arg == "--hashlife-mb" && hasValue) {
+            memoryLimitMb = std::stoull(argv[++i]);
+        } else if(arg == "--step-log" && hasValue) {
+            options.stepLog = std::stoi(argv[++i]);
+        } else if(arg == "--save" && hasValue) {
+            options.savePath = argv[++i];
+        } else if(arg == "--snapshot" && hasValue) {
+            options.snapshotPath = argv[++i];
+        } else if(arg == "--checkpoint-gens" && hasValue) {
+            options.checkpointGenerations = std::stol(argv[++i]);
+        } else if(arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if(arg == "--restore" && hasValue) {
+            options.restorePath = argv[++i];
+        } else if(arg == "--pattern-id" && hasValue) {
+            options.patternId = std::stoi(argv[++i]);
+        } else if(arg.find("--") != 0) {
+            width = height = std::stoi(arg);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(verify) {
+        ConformanceOptions verifyOptions;
+        verifyOptions.generations = options.generations;
+        verifyOptions.seed = options.seed;
+        verifyOptions.threads = threads;
+        verifyOptions.engine = engine;
+        ConformanceRunner runner = ConformanceRunner(verifyOptions);
+        return runner.run();
+    }
+
+    if(!options.restorePath.empty()) {
+        SnapshotHeader header;
+        if(!readSnapshotHeader(options.restorePath, header))
+            return 1;
+        width = header.width;
+        height = header.height;
+    }
+
+    if(headless) {
+        options.width = width;
+        options.height = height;
+        options.threads = threads;
+        options.kernel = kernel;
+        options.engine = engine;
+        options.memoryLimitMb = memoryLimitMb;
+        HeadlessRunner runner = HeadlessRunner(options);
+        return runner.run();
     }
 
-    ConwayApp app = ConwayApp(size);
-    app.run(); 
+    ConwayApp app = ConwayApp(width, height, threads, kernel, engine, memoryLimitMb);
+    if(!options.snapshotPath.empty())
+        app.setSnapshotPath(options.snapshotPath);
+    if(!tracePath.empty())
+        app.startTrace(tracePath);
+    if(!options.restorePath.empty())
+        app.openSnapshot(options.restorePath);
+    else if(!options.patternPath.empty())
+        app.openPattern(options.patternPath, options.patternId);
+    app.run();
 
     return 0;
 }
@@ -0,0 +1,122 @@
+// 
+// numberAtlasCache.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef NUMBERATLASCACHE_H
+#define NUMBERATLASCACHE_H
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <list>
+#include <string>
+
+#include "texture.h"
+#include "tracer.h"
+
+/*
+ * 3x3 atlases of the digits 0-8 rendered at different font sizes, least recently used are evicted.
+ * Zooming back and forth or resizing the window reuses the atlases of earlier sizes,
+ * the font stays open and is only resized for a missing size.
+ */
+class NumberAtlasCache {
+    public:
+        struct Atlas {
+            int fontSize;
+            Texture* texture;
+            int maxNumWidth;
+            int maxNumHeight;
+        };
+
+    private:
+        SDL_Renderer* renderer = nullptr;
+        TTF_Font* font = nullptr;
+        Tracer* tracer = nullptr;
+        const size_t capacity;
+        std::list<Atlas> atlases {};
+
+    public:
+        NumberAtlasCache(size_t capacity = 8) : capacity(capacity) { }
+
+        ~NumberAtlasCache() {
+            clear();
+        }
+
+        NumberAtlasCache(const NumberAtlasCache&) = delete;
+        NumberAtlasCache& operator=(const NumberAtlasCache&) = delete;
+
+        /*
+         * The font is owned by the caller and resized when an atlas is built
+         */
+        void setFont(SDL_Renderer* r, TTF_Font* f) {
+            clear();
+            renderer = r;
+            font = f;
+        }
+
+        void setTracer(Tracer* t) { tracer = t; }
+
+        void clear() {
+            for(Atlas& atlas : atlases)
+                delete atlas.texture;
+            atlases.clear();
+        }
+
+        /*
+         * Most recently used first, nullptr if the atlas can't be rendered
+         */
+        Atlas* get(int fontSize) {
+            fontSize = std::max(fontSize, 1);
+            for(auto it = atlases.begin(); it != atlases.end(); it++) {
+                if(it->fontSize == fontSize) {
+                    atlases.splice(atlases.begin(), atlases, it);
+                    return &atlases.front();
+                }
+            }
+
+            Atlas atlas = {fontSize, nullptr, 0, 0};
+            if(!build(atlas))
+                return nullptr;
+
+            atlases.push_front(atlas);
+            if(atlases.size() > capacity) {
+                delete atlases.back().texture;
+                atlases.pop_back();
+            }
+            return &atlases.front();
+        }
+
+        size_t size() { return atlases.size(); }
+
+    private:
+        bool build(Atlas& atlas) {
+            TraceScope trace(tracer, "numbers atlas");
+            if(font == nullptr || !TTF_SetFontSize(font, atlas.fontSize))
+                return false;
+
+            Texture nums[9];
+            for(int i = 0; i < 9; i++) {
+                nums[i].setRenderer(renderer);
+                if(!nums[i].loadText(std::to_string(i), font, {0,0,255}))
+                    return false;
+                atlas.maxNumWidth = std::max(atlas.maxNumWidth, nums[i].getWidth());
+                atlas.maxNumHeight = std::max(atlas.maxNumHeight, nums[i].getHeight());
+            }
+
+            atlas.texture = new Texture(renderer);
+            atlas.texture->loadBlank(atlas.maxNumWidth*3, atlas.maxNumHeight*3, SDL_TEXTUREACCESS_TARGET, nums[0].getFormat());
+            atlas.texture->setAsRenderTarget();
+            for(int i = 0; i < 9; i++) {
+                int x = (atlas.maxNumWidth-nums[i].getWidth())/2;
+                int y = (atlas.maxNumHeight-nums[i].getHeight())/2;
+                nums[i].render((i%3)*atlas.maxNumWidth + x, (i/3)*atlas.maxNumHeight + y);
+            }
+            SDL_SetRenderTarget(renderer, nullptr);
+            return true;
+        }
+};
+
+#endif /* NUMBERATLASCACHE_H */
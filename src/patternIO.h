@@ -0,0 +1,518 @@
+// 
+// patternIO.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef PATTERNIO_H
+#define PATTERNIO_H
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+/*
+ * Reading and writing of the RLE (.rle) and Macrocell (.mc) pattern formats, see:
+ * https://conwaylife.com/wiki/Run_Length_Encoded
+ * https://conwaylife.com/wiki/Macrocell
+ *
+ * The readers stream the file and write the cells row by row with Engine::setRowBits,
+ * a pattern is never expanded into a plaintext or per cell representation.
+ */
+
+inline bool patternError(const std::string& msg, const std::string& detail = "") {
+    std::cerr << "[Patterns] " << msg;
+    if(!detail.empty())
+        std::cerr << ": " << detail;
+    std::cerr << "\n";
+    return false;
+}
+
+inline bool hasExtension(const std::string& path, const std::string& extension) {
+    return path.size() >= extension.size()
+        && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/*
+ * Parses the whole string as a decimal number, surrounding whitespace is ignored
+ */
+inline bool parseLong(const std::string& str, long& value) {
+    size_t begin = str.find_first_not_of(" \t\r");
+    size_t end = str.find_last_not_of(" \t\r");
+    if(begin == std::string::npos)
+        return false;
+    const char* last = str.data() + end + 1;
+    std::from_chars_result result = std::from_chars(str.data() + begin, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+/*
+ * Only Conway's rule is simulated, an empty rule means B3/S23
+ */
+inline bool isConwayRule(std::string rule) {
+    rule.erase(std::remove_if(rule.begin(), rule.end(), [](unsigned char c) { return std::isspace(c); }), rule.end());
+    std::transform(rule.begin(), rule.end(), rule.begin(), [](unsigned char c) { return std::toupper(c); });
+    return rule.empty() || rule == "B3/S23" || rule == "23/3";
+}
+
+/*
+ * Sets count cells of the zeroed bit row dst starting at cell pos
+ */
+inline void fillBits(uint64_t* dst, long pos, long count) {
+    while(count > 0) {
+        int offset = pos % 64;
+        int n = std::min<long>(count, 64 - offset);
+        dst[pos/64] |= (n == 64 ? ~0ull : (1ull << n) - 1) << (64 - offset - n);
+        pos += n;
+        count -= n;
+    }
+}
+
+/*
+ * Number of consecutive cells in state alive of the bit row, starting at pos and ending at most at end
+ */
+inline long runLength(const uint64_t* bits, long pos, long end, bool alive) {
+    long start = pos;
+    while(pos < end) {
+        int offset = pos % 64;
+        uint64_t word = alive ? ~(bits[pos/64] << offset) : bits[pos/64] << offset;
+        int run = word == 0 ? 64 - offset : std::min(__builtin_clzll(word), 64 - offset);
+        pos += run;
+        if(run < 64 - offset)
+            break;
+    }
+    return std::min(pos, end) - start;
+}
+
+/*
+ * True if the text starts with an RLE header line, comment lines aside
+ */
+inline bool isRle(const std::string& text) {
+    std::istringstream stream(text);
+    std::string line;
+    while(std::getline(stream, line)) {
+        line.erase(line.begin(), std::find_if(line.begin(), line.end(),
+                    [](unsigned char c) { return !std::isspace(c); }));
+        if(line.empty() || line[0] == '#')
+            continue;
+        return line[0] == 'x' && line.find('=') != std::string::npos;
+    }
+    return false;
+}
+
+/*
+ * Reads an RLE pattern and places it in the center of the universe,
+ * dead cells of the pattern's bounding box overwrite the universe as well.
+ * Only a single row of the pattern is held in memory.
+ */
+inline bool readRle(std::istream& in, Engine* engine) {
+    std::string line;
+    long width = -1;
+    long height = -1;
+    std::string rule = "";
+    while(std::getline(in, line)) {
+        line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); }), line.end());
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        // x = m, y = n, rule = B3/S23
+        std::istringstream header(line);
+        std::string field;
+        while(std::getline(header, field, ',')) {
+            size_t split = field.find('=');
+            if(split == std::string::npos)
+                return patternError("Invalid RLE header", line);
+            std::string key = field.substr(0, split);
+            std::string value = field.substr(split + 1);
+            if((key == "x" && (!parseLong(value, width) || width < 0))
+                    || (key == "y" && (!parseLong(value, height) || height < 0)))
+                return patternError("Invalid RLE header", line);
+            if(key == "rule")
+                rule = value;
+        }
+        break;
+    }
+
+    if(width < 0 || height < 0)
+        return patternError("RLE header is missing");
+    if(!isConwayRule(rule))
+        return patternError("Unsupported rule, only B3/S23 is simulated", rule);
+    if(width > engine->width || height > engine->height)
+        return patternError("Pattern is too large for game of size",
+                std::to_string(engine->width) + "x" + std::to_string(engine->height));
+
+    int offsetX = (engine->width - width)/2;
+    int offsetY = (engine->height - height)/2;
+
+    std::vector<uint64_t> row((width + 63) / 64 + 1, 0);
+    long x = 0;
+    long y = 0;
+    auto flushRow = [&]() {
+        if(y < height && width > 0)
+            engine->setRowBits(offsetY + y, offsetX, offsetX + width, row.data());
+        std::fill(row.begin(), row.end(), 0);
+        x = 0;
+        y++;
+    };
+
+    // Characters straight from the stream buffer, runs are filled into the packed row
+    std::streambuf* buffer = in.rdbuf();
+    long count = 0;
+    for(int c = buffer->sbumpc(); c != std::char_traits<char>::eof(); c = buffer->sbumpc()) {
+        if(std::isdigit(c)) {
+            // No run is longer than a row or the number of rows, which also bounds count
+            count = count * 10 + (c - '0');
+            if(count > std::max(width, height))
+                return patternError("RLE run is longer than the pattern", std::to_string(y));
+            continue;
+        }
+        if(std::isspace(c))
+            continue;
+
+        long n = count == 0 ? 1 : count;
+        count = 0;
+        if(c == '!')
+            break;
+
+        if(c == '$') {
+            for(long i = 0; i < n && y < height; i++)
+                flushRow();
+            continue;
+        }
+
+        // Multi-state letters other than b are taken as alive
+        bool alive = c != 'b' && c != '.';
+        if(alive && x + n > width)
+            return patternError("RLE row is longer than the pattern width", std::to_string(y));
+        if(alive)
+            fillBits(row.data(), x, n);
+        x = std::min(x + n, width);
+    }
+
+    while(y < height)
+        flushRow();
+
+    return true;
+}
+
+/*
+ * Macrocell nodes, level 3 nodes are 8x8 leaves with row r in bits 63-8r to 56-8r
+ */
+struct MacrocellNode {
+    int level;
+    uint64_t leaf;
+    uint32_t children[4];  // nw, ne, sw, se, 0 is the empty node
+};
+
+inline void drawMacrocell(const std::vector<MacrocellNode>& nodes, uint32_t index, long x, long y, Engine* engine) {
+    const MacrocellNode& node = nodes[index];
+    long size = 1L << node.level;
+    if(index == 0 || x >= engine->width || y >= engine->height || x + size <= 0 || y + size <= 0)
+        return;
+
+    if(node.level > 3) {
+        long half = size / 2;
+        drawMacrocell(nodes, node.children[0], x,        y,        engine);
+        drawMacrocell(nodes, node.children[1], x + half, y,        engine);
+        drawMacrocell(nodes, node.children[2], x,        y + half, engine);
+        drawMacrocell(nodes, node.children[3], x + half, y + half, engine);
+        return;
+    }
+
+    // Leaf rows clipped to the universe
+    long gxBegin = std::max(x, 0L);
+    long gxEnd = std::min(x + 8, (long) engine->width);
+    for(int r = 0; r < 8; r++) {
+        if(y + r < 0 || y + r >= engine->height)
+            continue;
+        uint64_t bits = (node.leaf << (8 * r)) & 0xFF00000000000000;
+        bits <<= gxBegin - x;
+        engine->setRowBits(y + r, gxBegin, gxEnd, &bits);
+    }
+}
+
+/*
+ * Reads a two state Macrocell pattern and centers its root square in the universe.
+ * Cells outside the universe are dropped, empty nodes leave the universe untouched.
+ * The node table is kept as read, each node only takes a few words.
+ */
+inline bool readMacrocell(std::istream& in, Engine* engine) {
+    std::string line;
+    if(!std::getline(in, line) || line.rfind("[M2]", 0) != 0)
+        return patternError("Not a Macrocell file, [M2] header is missing");
+
+    std::vector<MacrocellNode> nodes(1, {3, 0, {0, 0, 0, 0}});
+    long generation = -1;
+    while(std::getline(in, line)) {
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if(line.empty())
+            continue;
+
+        if(line[0] == '#') {
+            if(line.rfind("#R", 0) == 0 && !isConwayRule(line.substr(2)))
+                return patternError("Unsupported rule, only B3/S23 is simulated", line.substr(2));
+            if(line.rfind("#G", 0) == 0 && (!parseLong(line.substr(2), generation) || generation < 0))
+                return patternError("Invalid Macrocell generation", line);
+            continue;
+        }
+
+        if(line[0] == '.' || line[0] == '*' || line[0] == '$') {
+            MacrocellNode leaf = {3, 0, {0, 0, 0, 0}};
+            int r = 0;
+            int c = 0;
+            for(char ch : line) {
+                if(ch == '$') {
+                    r++;
+                    c = 0;
+                    continue;
+                }
+                if(r >= 8 || c >= 8)
+                    return patternError("Invalid Macrocell leaf", line);
+                if(ch == '*')
+                    leaf.leaf |= 1ull << (63 - (r*8 + c));
+                c++;
+            }
+            nodes.push_back(leaf);
+            continue;
+        }
+
+        MacrocellNode node = {0, 0, {0, 0, 0, 0}};
+        std::istringstream fields(line);
+        fields >> node.level >> node.children[0] >> node.children[1] >> node.children[2] >> node.children[3];
+        if(fields.fail() || node.level <= 3 || node.level > 62)
+            return patternError("Invalid Macrocell node", line);
+        for(uint32_t child : node.children)
+            if(child >= nodes.size() || (child != 0 && nodes[child].level != node.level - 1))
+                return patternError("Invalid Macrocell node", line);
+        nodes.push_back(node);
+    }
+
+    if(nodes.size() > 1) {
+        long size = 1L << nodes.back().level;
+        drawMacrocell(nodes, nodes.size() - 1, (engine->width - size)/2, (engine->height - size)/2, engine);
+    }
+    if(generation >= 0)
+        engine->generation = generation;
+
+    return true;
+}
+
+/*
+ * Writes the bounding box of all live cells as RLE, lines are wrapped at 70 characters
+ */
+inline bool writeRle(std::ostream& out, Engine* engine) {
+    int rowWords = (engine->width + 63) / 64;
+    std::vector<uint64_t> bits(rowWords + 1);
+
+    int minX = engine->width;
+    int maxX = -1;
+    int minY = -1;
+    int maxY = -1;
+    for(int y = 0; y < engine->height; y++) {
+        engine->getRowBits(y, 0, engine->width, bits.data());
+        for(int w = 0; w < rowWords; w++) {
+            if(bits[w] == 0)
+                continue;
+            minX = std::min(minX, w*64 + __builtin_clzll(bits[w]));
+            maxX = std::max(maxX, w*64 + 63 - __builtin_ctzll(bits[w]));
+            if(minY < 0)
+                minY = y;
+            maxY = y;
+        }
+    }
+
+    out << "#C Generation " << engine->generation << "\n";
+    if(maxX < 0) {
+        out << "x = 0, y = 0, rule = B3/S23\n!\n";
+        return out.good();
+    }
+
+    long width = maxX - minX + 1;
+    out << "x = " << width << ", y = " << (maxY - minY + 1) << ", rule = B3/S23\n";
+
+    size_t lineLength = 0;
+    auto emit = [&](long count, char tag) {
+        std::string token = (count > 1 ? std::to_string(count) : "") + tag;
+        if(lineLength + token.size() > 70) {
+            out << "\n";
+            lineLength = 0;
+        }
+        out << token;
+        lineLength += token.size();
+    };
+
+    int lastRow = minY;
+    for(int y = minY; y <= maxY; y++) {
+        engine->getRowBits(y, minX, maxX + 1, bits.data());
+        bool empty = true;
+        for(int w = 0; w < (width + 63) / 64; w++)
+            empty &= bits[w] == 0;
+        if(empty)
+            continue;
+
+        if(y > minY)
+            emit(y - lastRow, '$');
+        lastRow = y;
+
+        // Trailing dead cells of a row are left out
+        for(long x = 0; x < width;) {
+            bool alive = (bits[x/64] >> (63 - x%64)) & 0x1;
+            long run = runLength(bits.data(), x, width, alive);
+            if(alive || x + run < width)
+                emit(run, alive ? 'o' : 'b');
+            x += run;
+        }
+    }
+    emit(1, '!');
+    out << "\n";
+
+    return out.good();
+}
+
+/*
+ * Writes the universe as a Macrocell quadtree, identical nodes are written only once.
+ * Empty squares are detected with getDensityRow before descending,
+ * engines that know their populations (hashlife) skip them without reading any cells.
+ */
+class MacrocellWriter {
+    private:
+        Engine* engine;
+        std::ostream& out;
+        uint32_t nodeCount = 0;
+        std::map<uint64_t, uint32_t> leaves {};
+        std::map<std::array<uint32_t, 5>, uint32_t> nodes {};
+
+    public:
+        MacrocellWriter(Engine* engine, std::ostream& out) : engine(engine), out(out) { }
+
+        bool write() {
+            int level = 3;
+            while((1L << level) < std::max(engine->width, engine->height))
+                level++;
+
+            // Universe centered in the root square the same way readMacrocell centers it again
+            long size = 1L << level;
+            out << "[M2] (ConwaysGameOfLife)\n#R B3/S23\n#G " << engine->generation << "\n";
+            if(writeNode(level, (engine->width - size)/2, (engine->height - size)/2) == 0)
+                out << "4 0 0 0 0\n";
+            return out.good();
+        }
+
+    private:
+        bool isEmpty(int level, long x, long y) {
+            long size = 1L << level;
+            // Counts are 32 bit
+            if(x < 0 || y < 0 || x + size > engine->width || y + size > engine->height || level > 15)
+                return false;
+            uint32_t alive = 0;
+            engine->getDensityRow(y, level, x, x + size, &alive);
+            return alive == 0;
+        }
+
+        uint32_t writeLeaf(long x, long y) {
+            uint64_t leaf = 0;
+            uint64_t bits[2] = {0, 0};
+            long xBegin = std::max(x, 0L);
+            long xEnd = std::min(x + 8, (long) engine->width);
+            for(int r = 0; r < 8 && y + r < engine->height; r++) {
+                if(y + r < 0)
+                    continue;
+                engine->getRowBits(y + r, xBegin, xEnd, bits);
+                leaf |= ((bits[0] >> (xBegin - x)) >> 56) << (56 - 8*r);
+            }
+            if(leaf == 0)
+                return 0;
+
+            auto it = leaves.find(leaf);
+            if(it != leaves.end())
+                return it->second;
+
+            for(int r = 0; r < 8 && (leaf << (8*r)) != 0; r++) {
+                uint8_t row = leaf >> (56 - 8*r);
+                for(int c = 0; c < 8 && (uint8_t) (row << c) != 0; c++)
+                    out << ((row >> (7 - c)) & 0x1 ? '*' : '.');
+                out << '$';
+            }
+            out << "\n";
+
+            leaves[leaf] = ++nodeCount;
+            return nodeCount;
+        }
+
+        uint32_t writeNode(int level, long x, long y) {
+            long size = 1L << level;
+            if(x >= engine->width || y >= engine->height || x + size <= 0 || y + size <= 0)
+                return 0;
+            if(level == 3)
+                return writeLeaf(x, y);
+            if(isEmpty(level, x, y))
+                return 0;
+
+            long half = 1L << (level - 1);
+            std::array<uint32_t, 5> key = {(uint32_t) level,
+                writeNode(level - 1, x,        y),
+                writeNode(level - 1, x + half, y),
+                writeNode(level - 1, x,        y + half),
+                writeNode(level - 1, x + half, y + half)};
+            if(key[1] == 0 && key[2] == 0 && key[3] == 0 && key[4] == 0)
+                return 0;
+
+            auto it = nodes.find(key);
+            if(it != nodes.end())
+                return it->second;
+
+            out << level << " " << key[1] << " " << key[2] << " " << key[3] << " " << key[4] << "\n";
+            nodes[key] = ++nodeCount;
+            return nodeCount;
+        }
+};
+
+inline bool writeMacrocell(std::ostream& out, Engine* engine) {
+    return MacrocellWriter(engine, out).write();
+}
+
+/*
+ * True for files loadPattern reads natively, other files are plaintext patterns
+ */
+inline bool isRleOrMacrocell(const std::string& path) {
+    return hasExtension(path, ".rle") || hasExtension(path, ".mc");
+}
+
+/*
+ * Loads a .rle or .mc file into the universe, the format is picked by extension
+ */
+inline bool loadPattern(const std::string& path, Engine* engine) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file.is_open())
+        return patternError("Failed to load pattern file", path);
+
+    if(hasExtension(path, ".mc"))
+        return readMacrocell(file, engine);
+    return readRle(file, engine);
+}
+
+/*
+ * Saves the universe as Macrocell for .mc paths and as RLE otherwise
+ */
+inline bool savePattern(const std::string& path, Engine* engine) {
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open())
+        return patternError("Failed to write pattern file", path);
+
+    if(hasExtension(path, ".mc"))
+        return writeMacrocell(file, engine);
+    return writeRle(file, engine);
+}
+
+#endif /* PATTERNIO_H */
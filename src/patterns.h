@@ -0,0 +1,68 @@
+// 
+// patterns.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef PATTERNS_H
+#define PATTERNS_H
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Reads a pattern collection (see resources/patterns.txt) where each
+ * pattern is enclosed in braces and '//' starts a comment line.
+ * A file without any braces is read as a single plaintext pattern,
+ * lines starting with '!' (.cells header) are skipped.
+ */
+inline bool loadPatternFile(const std::string& path, std::vector<std::string>& patterns) {
+    std::ifstream patternFile(path);
+    if(!patternFile.is_open()) {
+        std::cerr << "[Patterns] Failed to load pattern file: " << path << "\n";
+        return false;
+    }
+
+    std::stringstream content;
+    content << patternFile.rdbuf();
+    bool isCollection = content.str().find("{") != std::string::npos;
+
+    std::string line;
+    bool readingPattern = !isCollection;
+    std::string pattern = "";
+    while(std::getline(content, line)) {
+        // Trim start
+        line.erase(line.begin(), std::find_if(line.begin(), line.end(),
+                    [](unsigned char c) { return !std::isspace(c); }));
+
+        if(line.find("//") == 0 || line.find("!") == 0 || line.empty())
+            continue;
+
+        if(isCollection && line.find("{") != std::string::npos) {
+            readingPattern = true;
+            continue;
+        } else if(isCollection && line.find("}") != std::string::npos) {
+            readingPattern = false;
+            patterns.push_back(pattern);
+            pattern = "";
+            continue;
+        }
+
+        if(!readingPattern)
+            std::cerr << "[Patterns] Syntax error in pattern file: " << line << "\n";
+
+        pattern.append(line + "\n");
+    }
+
+    if(!isCollection && !pattern.empty())
+        patterns.push_back(pattern);
+
+    return true;
+}
+
+#endif /* PATTERNS_H */
@@ -0,0 +1,337 @@
+// 
+// planeUniverse.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef PLANEUNIVERSE_H
+#define PLANEUNIVERSE_H
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bitUniverse.h"
+#include "engine.h"
+#include "threadPool.h"
+
+/*
+ * 64 x 64 cells of the plane, one word per row as in the bitboard engine
+ */
+struct PlaneTile {
+    std::array<uint64_t, 64> cells {};
+    std::array<uint64_t, 64> next {};
+    bool changed = true;
+    bool empty = false;
+    int emptyGenerations = 0;
+
+    bool isEmpty() const {
+        uint64_t any = 0;
+        for(uint64_t row : cells)
+            any |= row;
+        return any == 0;
+    }
+};
+
+/*
+ * Unbounded engine, the universe is an infinite plane instead of a torus.
+ * Only tiles with live cells exist, they are kept in a hash map by tile coordinate.
+ * Tiles are allocated as soon as a live cell touches their border and freed once they
+ * stayed empty for a few generations next to empty tiles only, so memory and step time 
+ * scale with the live area while the empty ring around still lifes is kept.
+ * Like in the nibble engine, only tiles that changed or border a changed tile are computed.
+ *
+ * The width x height cells starting at the origin are the part shown and edited,
+ * patterns can leave it and keep evolving outside.
+ */
+class PlaneUniverse : public Engine {
+    private:
+        static const int tileLog = 6;
+        static const int tileSize = 1 << tileLog;
+        static const int keepEmptyGenerations = 4;
+
+        std::unordered_map<uint64_t, PlaneTile*> tiles {};
+
+        // Tile and its 8 neighbours in row-major order, nullptr for missing tiles
+        struct Neighbourhood {
+            PlaneTile* tiles[9];
+        };
+
+    public:
+        PlaneUniverse(int width, int height) :
+        Engine(std::max(width, 1), std::max(height, 1)) { }
+
+        ~PlaneUniverse() {
+            clear();
+        }
+
+        std::string getName() { return "plane"; }
+
+        size_t getTileCount() { return tiles.size(); }
+
+        void initGolRandom() {
+            initGolClear();
+            for(int gy = 0; gy < height; gy++)
+                for(int gx = 0; gx < width; gx++)
+                    if(rand() % 3 < 1)
+                        setCellState(gx, gy);
+        }
+
+        void initGolClear() {
+            generation = 0;
+            clear();
+        }
+
+        void initGolFull() {
+            initGolClear();
+            for(int gy = 0; gy < height; gy++)
+                for(int gx = 0; gx < width; gx++)
+                    setCellState(gx, gy);
+        }
+
+        void step(ThreadPool* pool = nullptr) {
+            expand();
+
+            // Collected before computing, the changed flags are those of the last generation
+            std::vector<Neighbourhood> active {};
+            for(auto& entry : tiles) {
+                int tx = (int32_t) (entry.first >> 32);
+                int ty = (int32_t) entry.first;
+                Neighbourhood h;
+                bool anyChanged = false;
+                for(int i = 0; i < 9; i++) {
+                    h.tiles[i] = i == 4 ? entry.second : findTile(tx + i%3 - 1, ty + i/3 - 1);
+                    anyChanged |= h.tiles[i] != nullptr && h.tiles[i]->changed;
+                }
+                if(anyChanged)
+                    active.push_back(h);
+            }
+
+            std::vector<uint8_t> changed(active.size());
+            auto computeTiles = [&](int begin, int end) {
+                for(int i = begin; i < end; i++)
+                    changed[i] = nextTile(active[i]);
+            };
+
+            if(pool == nullptr)
+                computeTiles(0, active.size());
+            else
+                pool->parallelFor(0, active.size(), computeTiles, 16);
+
+            for(auto& entry : tiles)
+                entry.second->changed = false;
+            for(size_t i = 0; i < active.size(); i++) {
+                PlaneTile* tile = active[i].tiles[4];
+                tile->cells.swap(tile->next);
+                tile->changed = changed[i];
+            }
+
+            shrink();
+            generation++;
+        }
+
+        uint64_t population() {
+            uint64_t alive = 0;
+            for(auto& entry : tiles)
+                for(uint64_t row : entry.second->cells)
+                    alive += __builtin_popcountll(row);
+            return alive;
+        }
+
+        bool getCellState(int gx, int gy) {
+            PlaneTile* tile = findTile(gx >> tileLog, gy >> tileLog);
+            return tile != nullptr && (tile->cells[gy & (tileSize-1)] & cellBit(gx));
+        }
+
+        void setCellState(int gx, int gy) {
+            PlaneTile* tile = getTile(gx >> tileLog, gy >> tileLog);
+            tile->cells[gy & (tileSize-1)] |= cellBit(gx);
+            tile->changed = true;
+        }
+
+        void unsetCellState(int gx, int gy) {
+            PlaneTile* tile = findTile(gx >> tileLog, gy >> tileLog);
+            if(tile == nullptr)
+                return;
+            tile->cells[gy & (tileSize-1)] &= ~cellBit(gx);
+            tile->changed = true;
+        }
+
+        /*
+         * No wrap around, the neighbours at the border of the shown area can lie outside
+         */
+        int getNeighbourCount(int gx, int gy) {
+            int count = 0;
+            for(int dy = -1; dy <= 1; dy++)
+                for(int dx = -1; dx <= 1; dx++)
+                    if(dx != 0 || dy != 0)
+                        count += getCellState(gx + dx, gy + dy);
+            return count;
+        }
+
+        void setRowBits(int gy, int gxBegin, int gxEnd, const uint64_t* src) {
+            for(int gx = gxBegin; gx < gxEnd;) {
+                int tileEnd = std::min(gxEnd, ((gx >> tileLog) + 1) * tileSize);
+                int n = tileEnd - gx;
+                int shift = 64 - (gx & (tileSize-1)) - n;
+                uint64_t mask = (n == 64 ? ~0ull : (1ull << n) - 1) << shift;
+                uint64_t bits = extractBits(src, gx - gxBegin, n) << shift;
+
+                // Dead cells do not need a tile
+                PlaneTile* tile = bits != 0 ? getTile(gx >> tileLog, gy >> tileLog) 
+                    : findTile(gx >> tileLog, gy >> tileLog);
+                if(tile != nullptr) {
+                    uint64_t& word = tile->cells[gy & (tileSize-1)];
+                    word = (word & ~mask) | bits;
+                    tile->changed = true;
+                }
+                gx = tileEnd;
+            }
+        }
+
+        void getRowBits(int gy, int gxBegin, int gxEnd, uint64_t* dst) {
+            std::fill(dst, dst + (gxEnd - gxBegin + 63) / 64, 0);
+            for(int gx = gxBegin; gx < gxEnd;) {
+                int tileEnd = std::min(gxEnd, ((gx >> tileLog) + 1) * tileSize);
+                int n = tileEnd - gx;
+                PlaneTile* tile = findTile(gx >> tileLog, gy >> tileLog);
+                if(tile != nullptr) {
+                    uint64_t bits = tile->cells[gy & (tileSize-1)] >> (64 - (gx & (tileSize-1)) - n);
+                    appendBits(dst, gx - gxBegin, n == 64 ? bits : bits & ((1ull << n) - 1), n);
+                }
+                gx = tileEnd;
+            }
+        }
+
+    private:
+        static uint64_t cellBit(int gx) { return 1ull << (63 - (gx & (tileSize-1))); }
+
+        static uint64_t key(int tx, int ty) { return ((uint64_t) (uint32_t) tx << 32) | (uint32_t) ty; }
+
+        PlaneTile* findTile(int tx, int ty) {
+            auto it = tiles.find(key(tx, ty));
+            return it == tiles.end() ? nullptr : it->second;
+        }
+
+        PlaneTile* getTile(int tx, int ty) {
+            PlaneTile*& tile = tiles[key(tx, ty)];
+            if(tile == nullptr)
+                tile = new PlaneTile();
+            return tile;
+        }
+
+        void clear() {
+            for(auto& entry : tiles)
+                delete entry.second;
+            tiles.clear();
+        }
+
+        /*
+         * Allocates the missing neighbours of all tiles with live border cells,
+         * only those can give birth to cells outside the existing tiles
+         */
+        void expand() {
+            std::vector<uint64_t> missing {};
+            for(auto& entry : tiles) {
+                const PlaneTile* tile = entry.second;
+                uint64_t west = 0;
+                uint64_t east = 0;
+                for(uint64_t row : tile->cells) {
+                    west |= row >> 63;
+                    east |= row & 0x1;
+                }
+                uint64_t north = tile->cells[0];
+                uint64_t south = tile->cells[tileSize-1];
+                if(north == 0 && south == 0 && west == 0 && east == 0)
+                    continue;
+
+                bool border[9] = {
+                    (north >> 63) != 0, north != 0, (north & 0x1) != 0,
+                    west != 0, false, east != 0,
+                    (south >> 63) != 0, south != 0, (south & 0x1) != 0
+                };
+
+                int tx = (int32_t) (entry.first >> 32);
+                int ty = (int32_t) entry.first;
+                for(int i = 0; i < 9; i++) {
+                    uint64_t k = key(tx + i%3 - 1, ty + i/3 - 1);
+                    if(border[i] && tiles.find(k) == tiles.end())
+                        missing.push_back(k);
+                }
+            }
+
+            // Inserted afterwards, inserting while iterating can rehash the map
+            for(uint64_t k : missing) {
+                PlaneTile*& tile = tiles[k];
+                if(tile == nullptr)
+                    tile = new PlaneTile();
+            }
+        }
+
+        /*
+         * Frees tiles that are empty, did not change for a few generations and have no live 
+         * neighbour tile. Such tiles do not affect their neighbours and expand() would not
+         * allocate them again in the next generation.
+         */
+        void shrink() {
+            for(auto& entry : tiles) {
+                PlaneTile* tile = entry.second;
+                tile->empty = tile->isEmpty();
+                tile->emptyGenerations = tile->empty && !tile->changed ? tile->emptyGenerations + 1 : 0;
+            }
+
+            for(auto it = tiles.begin(); it != tiles.end();) {
+                if(it->second->emptyGenerations > keepEmptyGenerations && !hasLiveNeighbour(it->first)) {
+                    delete it->second;
+                    it = tiles.erase(it);
+                } else {
+                    it++;
+                }
+            }
+        }
+
+        bool hasLiveNeighbour(uint64_t k) {
+            int tx = (int32_t) (k >> 32);
+            int ty = (int32_t) k;
+            for(int i = 0; i < 9; i++) {
+                PlaneTile* neighbour = i == 4 ? nullptr : findTile(tx + i%3 - 1, ty + i/3 - 1);
+                if(neighbour != nullptr && !neighbour->empty)
+                    return true;
+            }
+            return false;
+        }
+
+        static uint64_t word(const PlaneTile* tile, int y) {
+            return tile == nullptr ? 0 : tile->cells[y];
+        }
+
+        /*
+         * Computes the next state of the center tile into its next buffer,
+         * returns true if a cell changed
+         */
+        static bool nextTile(const Neighbourhood& h) {
+            PlaneTile* tile = h.tiles[4];
+            uint64_t changed = 0;
+            for(int y = 0; y < tileSize; y++) {
+                // Rows above and below, taken from the neighbouring tile row at the tile border
+                int north = y == 0 ? 0 : 3;
+                int south = y == tileSize-1 ? 6 : 3;
+                int yN = (y - 1) & (tileSize-1);
+                int yS = (y + 1) & (tileSize-1);
+
+                uint64_t next = BitUniverse::nextWord(
+                        word(h.tiles[north], yN), word(h.tiles[north+1], yN), word(h.tiles[north+2], yN),
+                        word(h.tiles[3], y), tile->cells[y], word(h.tiles[5], y),
+                        word(h.tiles[south], yS), word(h.tiles[south+1], yS), word(h.tiles[south+2], yS));
+                tile->next[y] = next;
+                changed |= next ^ tile->cells[y];
+            }
+            return changed != 0;
+        }
+};
+
+#endif /* PLANEUNIVERSE_H */
@@ -0,0 +1,101 @@
+// 
+// profiler.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+#include "tracer.h"
+
+/*
+ * Time spent per frame in named zones, averaged over the last frames.
+ * A zone can be entered several times per frame, its times add up until endFrame().
+ * Zones are listed in the order they were first entered.
+ */
+class Profiler {
+    public:
+        enum Lane { RenderLoop, SimulationThread };
+
+        struct Zone {
+            std::string name;
+            Lane lane;
+            Timer average;
+            long frameNs = 0;
+        };
+
+    private:
+        std::vector<Zone> zones {};
+        const int averageFrames;
+        Tracer* tracer = nullptr;
+
+    public:
+        Profiler(int averageFrames = 32) : averageFrames(averageFrames) { }
+
+        /*
+         * Zones are also recorded as trace events while the tracer is enabled
+         */
+        void setTracer(Tracer* t) { tracer = t; }
+
+        Tracer* getTracer() { return tracer; }
+
+        int getZone(const std::string& name, Lane lane = RenderLoop) {
+            for(int i = 0; i < (int) zones.size(); i++)
+                if(zones[i].name == name)
+                    return i;
+            zones.push_back({name, lane, Timer(averageFrames)});
+            return zones.size() - 1;
+        }
+
+        void add(int zone, long ns) { zones[zone].frameNs += ns; }
+
+        /*
+         * Time measured outside of a ProfileZone, e.g. on another thread
+         */
+        void record(const std::string& name, long ns, Lane lane = RenderLoop) {
+            add(getZone(name, lane), ns);
+        }
+
+        /*
+         * Adds the times of this frame to the averages, zones not entered count as 0
+         */
+        void endFrame() {
+            for(Zone& zone : zones) {
+                zone.average.add(zone.frameNs);
+                zone.frameNs = 0;
+            }
+        }
+
+        const std::vector<Zone>& getZones() { return zones; }
+};
+
+/*
+ * Times its scope and adds it to the zone of the profiler, names must be string literals
+ */
+class ProfileZone {
+    private:
+        Profiler& profiler;
+        int zone;
+        TraceScope trace;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        ProfileZone(Profiler& profiler, const char* name) : profiler(profiler), zone(profiler.getZone(name)),
+        trace(profiler.getTracer(), name), start(std::chrono::steady_clock::now()) { }
+
+        ~ProfileZone() {
+            profiler.add(zone, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#endif /* PROFILER_H */
@@ -18,7 +18,12 @@
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
 
+#include "glyphAtlas.h"
+#include "profiler.h"
+#include "tracer.h"
 #include "timer.h"
 #include "texture.h"
 
@@ -49,14 +54,30 @@ class SDLApp {
         TTF_Font* debugFont = nullptr;
         TTF_Font* monoFont = nullptr;
         int monoFontSize = 20;
+        GlyphAtlas monoGlyphs;
+        int idleTimeoutMs = 500;
+
+        Tracer tracer;
+        Profiler profiler;
+        bool showProfiler = false;
 
     private:
         Timer frameTimer = Timer(32);
         TTF_Font* fpsFont = nullptr;
         const std::string fpsText = "Fps:";
         const int fpsFontSize = 16;
-        Texture fpsTexture;
+        GlyphAtlas fpsGlyphs;
+        std::string fpsLine = "";
         std::unordered_map<std::string, DebugRect> debugRects{}; 
+        std::string profilerText = "";
+        Histogram frameHistogram;
+        Histogram frameWindow;
+        std::string windowPercentiles = "";
+        Uint64 windowStartTicks = 0;
+        const Uint64 percentileWindowMs = 2000;
+        float fpsBoxBottom = 40;
+        Uint64 profilerTextTicks = 0;
+        const Uint64 profilerTextRefreshMs = 250;
 
     public:
         SDLApp(std::string name, int initWidth, int initHeight) : programName(name), basePath(SDL_GetBasePath()) {
@@ -94,8 +115,10 @@ class SDLApp {
             if(debugFont == nullptr || monoFont == nullptr || fpsFont == nullptr) 
                 error("SDL font creation failed", SDL_GetError());
 
-            fpsTexture.setRenderer(renderer);
-            fpsTexture.loadBlank(256, 256, SDL_TEXTUREACCESS_STREAMING, SDL_PIXELFORMAT_ARGB8888);
+            // Overlay text is composed from glyphs rasterized once
+            if(!monoGlyphs.load(renderer, monoFont) || !fpsGlyphs.load(renderer, fpsFont))
+                error("Glyph atlas creation failed", SDL_GetError());
+            profiler.setTracer(&tracer);
             SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
         }
 
@@ -134,20 +157,43 @@ class SDLApp {
 
         void run() {
             while(!quit) {
+                // Nothing changes until the next event, don't redraw the same frame
+                if(isIdle())
+                    SDL_WaitEventTimeout(nullptr, idleTimeoutMs);
+
+                TraceScope trace(&tracer, "frame");
                 frameTimer.start();
                 SDL_GetRenderOutputSize(renderer, &screenWidth, &screenHeight);
                 SDL_SetRenderDrawColor(renderer, background.r, background.g, background.b, 255);
                 SDL_RenderClear(renderer);
                 
-                eventHandler();
+                {
+                    ProfileZone zone(profiler, "events");
+                    eventHandler();
+                }
                 render();
                 
-                renderFps();
-
-                SDL_RenderPresent(renderer);
+                {
+                    ProfileZone zone(profiler, "overlays");
+                    renderFps();
+                    if(showProfiler)
+                        renderProfiler();
+                }
+
+                {
+                    // Includes waiting for vsync and the draw calls the renderer batched up
+                    ProfileZone zone(profiler, "present");
+                    SDL_RenderPresent(renderer);
+                }
                 frameTimer.stop();
+                frameHistogram.record(frameTimer.getNs());
+                frameWindow.record(frameTimer.getNs());
                 lastFrameAverageMs = frameTimer.getAverageMs();
+                profiler.endFrame();
             }
+
+            std::cout << "[" << programName << "] Frame times of " << frameHistogram.getCount() 
+                << " frames: " << frameHistogram.toString() << "\n";
         }
 
         std::string getBasePath() { return basePath; }
@@ -156,6 +202,22 @@ class SDLApp {
 
     protected:
         virtual void render() { }
+
+        /*
+         * True if the frame would be the same as the last one,
+         * the loop then waits for the next event instead of rendering
+         */
+        virtual bool isIdle() { return false; }
+
+        /*
+         * Wakes up an idle loop, can be called from any thread
+         */
+        void requestRedraw() {
+            SDL_Event wakeEvent;
+            SDL_zero(wakeEvent);
+            wakeEvent.type = SDL_EVENT_USER;
+            SDL_PushEvent(&wakeEvent);
+        }
         
         virtual void keyDownEventHandler(SDL_Event& event) { }
         
@@ -171,6 +233,12 @@ class SDLApp {
         
         virtual void windowResized() { }
 
+        /*
+         * Further lines below the frame time percentiles, 
+         * called once per percentile window
+         */
+        virtual std::string windowStats() { return ""; }
+
         void renderDebugRect(std::string name, int x, int y, int w, int h) {
             if(!debugRects.contains(name)) {
                 SDL_Color color = hslToRgb((rand()%255)/255.0, 0.9, 0.7);
@@ -212,24 +280,97 @@ class SDLApp {
             float textOffsetX = 8;
             float textOffsetTop = 3;
             float textOffsetBottom = 5;
-            std::stringstream fpsStream;
-            fpsStream << std::fixed << std::setprecision(2) << fps;
-            std::string fpsStr = fpsStream.str();
-            int fpsPadding = std::max((int) (5-fpsStr.find(".")), 1);
-            fpsStr = fpsText + std::string(fpsPadding, ' ') + fpsStr;
-            SDL_Surface* textSurface = TTF_RenderText_Blended(fpsFont, 
-                    fpsStr.c_str(), fpsStr.length(), {200,50,50});
-            SDL_FRect fclip = {0.0, 0.0, (float)textSurface->w, (float)textSurface->h};
-            fpsTexture.update(textSurface);     
-            SDL_FRect fpsRect = {offset, offset, (float)fclip.w + textOffsetX*2, 
-                (float)fclip.h + textOffsetTop + textOffsetBottom};
+            char fpsNumber[32];
+            int length = snprintf(fpsNumber, sizeof(fpsNumber), "%.2f", fps);
+            int fpsPadding = std::max((int) (5 - (std::find(fpsNumber, fpsNumber + length, '.') - fpsNumber)), 1);
+            fpsLine.assign(fpsText);
+            fpsLine.append(fpsPadding, ' ');
+            fpsLine.append(fpsNumber, length);
+
+            // Percentiles of the last window, the mean hides jitter and slow frames
+            Uint64 ticks = SDL_GetTicks();
+            if(ticks - windowStartTicks >= percentileWindowMs) {
+                windowPercentiles = frameWindow.getCount() == 0 ? "" : "\nframe " + frameWindow.toString();
+                std::string stats = windowStats();
+                if(!stats.empty())
+                    windowPercentiles += "\n" + stats;
+                frameWindow.reset();
+                windowStartTicks = ticks;
+            }
+            fpsLine.append(windowPercentiles);
+
+            SDL_FRect fpsRect = {offset, offset, fpsGlyphs.getTextWidth(fpsLine) + textOffsetX*2, 
+                fpsGlyphs.getTextHeight(fpsLine) + textOffsetTop + textOffsetBottom};
             SDL_SetRenderDrawColor(renderer, 25, 25, 25, 128);
             SDL_RenderFillRect(renderer, &fpsRect);
+            fpsBoxBottom = fpsRect.y + fpsRect.h;
             SDL_SetRenderDrawColor(renderer, 255, 255, 255, 30);
             SDL_RenderRect(renderer, &fpsRect);
 
-            fpsTexture.render(offset + textOffsetX, offset + textOffsetTop, &fclip);
-            SDL_DestroySurface(textSurface);
+            fpsGlyphs.render(fpsLine, offset + textOffsetX, offset + textOffsetTop, {200, 50, 50, 255});
+        }
+
+        /*
+         * Average time per frame of every profiler zone, stacked in one bar for the render loop 
+         * and one for the simulation thread (scaled to the frame time, at least 60 fps) and as a table
+         */
+        void renderProfiler() {
+            float x = 10;
+            float y = fpsBoxBottom + 10;
+            float padding = 8;
+            float barWidth = 300;
+            float barHeight = 10;
+            float barGap = 4;
+            double scaleMs = std::max(lastFrameAverageMs, 1000.0/60);
+            const std::vector<Profiler::Zone>& zones = profiler.getZones();
+
+            // The numbers are only readable if they do not change every frame
+            Uint64 ticks = SDL_GetTicks();
+            if(profilerText.empty() || ticks - profilerTextTicks >= profilerTextRefreshMs) {
+                std::stringstream text;
+                text << std::fixed << std::setprecision(2) << "   " << std::left << std::setw(12) << "frame" 
+                    << std::right << std::setw(7) << lastFrameAverageMs << " ms\n";
+                for(const Profiler::Zone& zone : zones) {
+                    text << "   " << std::left << std::setw(12) << zone.name << std::right << std::setw(7) 
+                        << zone.average.getAverageMs() << " ms"
+                        << (zone.lane == Profiler::SimulationThread ? "  (simulation)" : "") << "\n";
+                }
+                profilerText = text.str();
+                profilerTextTicks = ticks;
+            }
+
+            float lineSkip = fpsGlyphs.getLineHeight();
+            float tableY = y + padding + 2 * (barHeight + barGap) + barGap;
+            SDL_FRect background = {x, y, std::max(barWidth, fpsGlyphs.getTextWidth(profilerText)) + 2*padding, 
+                tableY - y + fpsGlyphs.getTextHeight(profilerText) + padding};
+            SDL_SetRenderDrawColor(renderer, 25, 25, 25, 200);
+            SDL_RenderFillRect(renderer, &background);
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 30);
+            SDL_RenderRect(renderer, &background);
+
+            float barX[2] = {x + padding, x + padding};
+            for(int i = 0; i < (int) zones.size(); i++) {
+                SDL_Color color = hslToRgb(std::fmod(i * 0.618, 1.0), 0.7, 0.6);
+                SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+
+                int lane = zones[i].lane == Profiler::SimulationThread;
+                float width = zones[i].average.getAverageMs() / scaleMs * barWidth;
+                SDL_FRect bar = {barX[lane], y + padding + lane * (barHeight + barGap), 
+                    std::min(width, x + padding + barWidth - barX[lane]), barHeight};
+                SDL_RenderFillRect(renderer, &bar);
+                barX[lane] += bar.w;
+
+                SDL_FRect swatch = {x + padding, tableY + (i + 1) * lineSkip + lineSkip/4, lineSkip/2, lineSkip/2};
+                SDL_RenderFillRect(renderer, &swatch);
+            }
+
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 60);
+            for(int lane = 0; lane < 2; lane++) {
+                SDL_FRect outline = {x + padding, y + padding + lane * (barHeight + barGap), barWidth, barHeight};
+                SDL_RenderRect(renderer, &outline);
+            }
+
+            fpsGlyphs.render(profilerText, x + padding, tableY, {220, 220, 220, 255});
         }
 
         void error(std::string msg, std::string detail = "") {
@@ -267,6 +408,19 @@ inline SDL_Color hslToRgb(double h, double s, double l) {
     return SDL_Color{(Uint8) r, (Uint8) g, (Uint8) b};
 }
 
+/*
+ * Blends two packed 32 bit colors channel by channel, amount from 0 (from) to 255 (to)
+ */
+inline Uint32 blendColor(Uint32 from, Uint32 to, int amount) {
+    Uint32 color = 0;
+    for(int shift = 0; shift < 32; shift += 8) {
+        int a = (from >> shift) & 0xFF;
+        int b = (to >> shift) & 0xFF;
+        color |= (Uint32) ((a * (255 - amount) + b * amount) / 255) << shift;
+    }
+    return color;
+}
+
 inline void drawRectangle(SDL_Renderer* renderer, const SDL_FRect& rect, int thickness) {
     SDL_FPoint points[4] = {
         {rect.x+thickness/2.f, rect.y-thickness/2.f}, 
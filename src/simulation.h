@@ -0,0 +1,499 @@
+// 
+// simulation.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine.h"
+#include "threadPool.h"
+#include "timer.h"
+#include "tracer.h"
+#include "tripleBuffer.h"
+
+/*
+ * Rectangular region of cells, the part of the universe shown on screen
+ */
+struct CellRegion {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool operator==(const CellRegion& other) const {
+        return x == other.x && y == other.y && width == other.width && height == other.height;
+    }
+};
+
+/*
+ * Snapshot of the visible part of one generation as published by the simulation thread.
+ * Cells are stored with one bit per cell, rows padded to full words,
+ * and only expanded to pixels directly into the texture by the render loop.
+ * If the view has more cells than the screen pixels (lodLog > 0), squares of 
+ * 2^lodLog x 2^lodLog cells are reduced to a single density value instead,
+ * cells of a last incomplete square are left out. An axis shorter than a square 
+ * (long thin universes) is covered by one partial texel.
+ * Neighbour counts are only included if requested, for the text shown when zoomed in.
+ */
+struct Frame {
+    long generation = 0;
+    CellRegion view;
+    int lodLog = 0;
+    int rowWords = 0;
+    bool withCounts = false;
+    std::vector<uint64_t> cells;
+    std::vector<uint8_t> density;
+    std::vector<uint8_t> counts;
+
+    // Width and height in texels
+    int getWidth() const { return std::max(view.width >> lodLog, 1); }
+    int getHeight() const { return std::max(view.height >> lodLog, 1); }
+
+    // True if the state of the cell is part of the frame
+    bool contains(int gx, int gy) const {
+        return lodLog == 0 
+            && gx >= view.x && gx < view.x + view.width && gy >= view.y && gy < view.y + view.height;
+    }
+
+    bool getCellState(int gx, int gy) const {
+        int x = gx - view.x;
+        return (cells[x/64 + (size_t) (gy - view.y) * rowWords] >> (63 - x%64)) & 0x1;
+    }
+
+    int getNeighbourCount(int gx, int gy) const {
+        return counts[(gx - view.x) + (size_t) (gy - view.y) * view.width];
+    }
+
+    /*
+     * Writes the colors of row y of the view to dst
+     */
+    void expandRow(int y, uint32_t* dst, uint32_t colorAlive, uint32_t colorDead) const {
+        const uint64_t* row = cells.data() + (size_t) y * rowWords;
+        for(int x = 0; x < view.width; x++) {
+            uint32_t alive = -(uint32_t) ((row[x/64] >> (63 - x%64)) & 0x1);
+            dst[x] = (colorAlive & alive) | (colorDead & ~alive);
+        }
+    }
+
+    /*
+     * Writes palette indices of row y to dst, 0 to 255 from dead to alive
+     */
+    void expandRowIndexed(int y, uint8_t* dst) const {
+        if(lodLog > 0) {
+            std::memcpy(dst, density.data() + (size_t) y * getWidth(), getWidth());
+            return;
+        }
+
+        const uint64_t* row = cells.data() + (size_t) y * rowWords;
+        for(int x = 0; x < view.width; x++)
+            dst[x] = -(uint8_t) ((row[x/64] >> (63 - x%64)) & 0x1);
+    }
+
+    /*
+     * Writes the colors of texel row y of a density frame to dst, palette maps density to color
+     */
+    void expandDensityRow(int y, uint32_t* dst, const uint32_t* palette) const {
+        const uint8_t* row = density.data() + (size_t) y * getWidth();
+        for(int x = 0; x < getWidth(); x++)
+            dst[x] = palette[row[x]];
+    }
+};
+
+/*
+ * How far the running simulation may get ahead of the display
+ */
+struct Speed {
+    enum Mode { PerFrame, Budget, Uncapped };
+
+    // Uncapped by default, Budget and PerFrame tie the simulation to the display rate
+    Mode mode = Uncapped;
+    int generations = 1;    // PerFrame: generations per displayed frame
+    double budgetMs = 8.0;  // Budget: time spent stepping per displayed frame
+
+    std::string toString() const {
+        if(mode == PerFrame)
+            return std::to_string(generations) + "/frame";
+        if(mode == Budget)
+            return std::to_string((int) budgetMs) + "ms/frame";
+        return "uncapped";
+    }
+};
+
+/*
+ * Runs the engine on its own thread, independent of the render loop.
+ * Finished generations are rasterized into a triple buffer whenever the
+ * render loop picked up the previous one, so the simulation is never throttled by the display.
+ * All access to the engine goes through this thread, the render loop posts edits as commands
+ * which are applied between two generations.
+ */
+class Simulation {
+    private:
+        Engine* engine;
+        ThreadPool* pool;
+
+        TripleBuffer<Frame> frames;
+        std::thread thread;
+        std::function<void()> onPublish;
+        Tracer* tracer = nullptr;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<std::function<void(Engine*)>> commands;
+        CellRegion view;
+        int lodLog = 0;
+        bool withCounts = false;
+        bool viewChanged = false;
+        bool paused = true;
+        bool stopping = false;
+        int advance = 0;
+        int jump = 0;
+        int jumpLog = 0;
+        Speed speed;
+
+        // Only used by the simulation thread, progress since the last published frame
+        int stepsAhead = 0;
+        double msAhead = 0;
+
+        // Only used by the simulation thread, generations left of a jump the engine can't skip
+        long jumpRemaining = 0;
+
+        // Time spent stepping and rasterizing, collected by the render loop's profiler
+        std::atomic<long> stepNs {0};
+        std::atomic<long> rasterizeNs {0};
+
+        // Durations of single generations, since the start and since the last takeStepWindow()
+        std::mutex histogramMutex;
+        Histogram stepHistogram;
+        Histogram stepWindow;
+
+    public:
+        Simulation(Engine* engine, ThreadPool* pool) :
+        engine(engine),
+        pool(pool),
+        view({0, 0, engine->width, engine->height}) { }
+
+        ~Simulation() {
+            stop();
+        }
+
+        Simulation(const Simulation&) = delete;
+        Simulation& operator=(const Simulation&) = delete;
+
+        /*
+         * Called on the simulation thread after every published frame
+         */
+        void setPublishCallback(const std::function<void()>& callback) { onPublish = callback; }
+
+        /*
+         * Generations, jumps, edits and rasterization are recorded as trace events of the simulation thread
+         */
+        void setTracer(Tracer* t) { tracer = t; }
+
+        void start() {
+            if(!thread.joinable())
+                thread = std::thread(&Simulation::loop, this);
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            condition.notify_one();
+            if(thread.joinable())
+                thread.join();
+        }
+
+        /*
+         * Queues a change to the engine, applied before the next generation
+         */
+        void post(const std::function<void(Engine*)>& command) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                commands.push_back(command);
+            }
+            condition.notify_one();
+        }
+
+        void setPaused(bool p) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                paused = p;
+            }
+            condition.notify_one();
+        }
+
+        void setSpeed(const Speed& s) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                speed = s;
+            }
+            condition.notify_one();
+        }
+
+        void stepOnce() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                advance++;
+            }
+            condition.notify_one();
+        }
+
+        void jumpOnce(int log2Generations) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jump++;
+                jumpLog = log2Generations;
+            }
+            condition.notify_one();
+        }
+
+        /*
+         * Region of the universe rasterized into every frame, reduced to 
+         * 2^lod x 2^lod cells per texel, optionally with the neighbour counts of its cells
+         */
+        void setView(const CellRegion& region, int lod, bool counts) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(region == view && lod == lodLog && counts == withCounts)
+                    return;
+                view = region;
+                lodLog = lod;
+                withCounts = counts;
+                viewChanged = true;
+            }
+            condition.notify_one();
+        }
+
+        /*
+         * Render loop side, returns true if a newer frame is available
+         */
+        bool updateFrame() { return frames.update(); }
+
+        const Frame& getFrame() { return frames.getFront(); }
+
+        /*
+         * Time spent stepping/rasterizing since the last call
+         */
+        long takeStepNs() { return stepNs.exchange(0); }
+        long takeRasterizeNs() { return rasterizeNs.exchange(0); }
+
+        Histogram getStepHistogram() {
+            std::lock_guard<std::mutex> lock(histogramMutex);
+            return stepHistogram;
+        }
+
+        Histogram takeStepWindow() {
+            std::lock_guard<std::mutex> lock(histogramMutex);
+            Histogram window = stepWindow;
+            stepWindow.reset();
+            return window;
+        }
+
+    private:
+        /*
+         * Intermediate generations are never rasterized, only the last one before a frame is published
+         */
+        bool canRun() {
+            if(paused)
+                return false;
+            if(speed.mode == Speed::PerFrame)
+                return stepsAhead < speed.generations;
+            if(speed.mode == Speed::Budget)
+                return msAhead < speed.budgetMs;
+            return true;
+        }
+
+        bool hasWork() {
+            return stopping || !commands.empty() || canRun() || advance > 0 || jump > 0 || jumpRemaining > 0 || viewChanged;
+        }
+
+        void loop() {
+            // The current generation was not published yet
+            bool dirty = true;
+
+            while(true) {
+                std::vector<std::function<void(Engine*)>> pending;
+                CellRegion region;
+                int lod = 0;
+                bool counts = false;
+                bool doStep = false;
+                bool doJump = false;
+                int log2Generations = 0;
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if(!hasWork()) {
+                        if(!dirty)
+                            condition.wait(lock, [this] { return hasWork(); });
+                        else if(!frames.isConsumed())
+                            condition.wait_for(lock, std::chrono::milliseconds(1), [this] { return hasWork(); });
+                    }
+
+                    if(stopping)
+                        return;
+
+                    pending.swap(commands);
+                    region = view;
+                    lod = lodLog;
+                    counts = withCounts;
+                    dirty |= viewChanged;
+                    viewChanged = false;
+
+                    doStep = canRun() || advance > 0;
+                    if(advance > 0)
+                        advance--;
+
+                    doJump = jump > 0;
+                    if(doJump)
+                        jump--;
+                    log2Generations = jumpLog;
+                }
+
+                if(!pending.empty()) {
+                    TraceScope trace(tracer, "commands", Tracer::SimulationThread);
+                    for(auto& command : pending)
+                        command(engine);
+                }
+                dirty |= !pending.empty();
+
+                if(doStep) {
+                    TraceScope trace(tracer, "step", Tracer::SimulationThread);
+                    auto start = std::chrono::steady_clock::now();
+                    engine->step(pool);
+                    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                    msAhead += ns / 1e6;
+                    stepNs += ns;
+                    stepsAhead++;
+                    {
+                        std::lock_guard<std::mutex> lock(histogramMutex);
+                        stepHistogram.record(ns);
+                        stepWindow.record(ns);
+                    }
+                }
+
+                // Without a native jump one generation per iteration, commands and stop stay responsive
+                log2Generations = std::min(log2Generations, engine->getMaxJumpLog());
+                if(doJump && !engine->hasNativeJump()) {
+                    jumpRemaining += 1L << log2Generations;
+                    doJump = false;
+                }
+                bool doJumpStep = jumpRemaining > 0;
+
+                if(doJump || doJumpStep) {
+                    TraceScope trace(tracer, "jump", Tracer::SimulationThread);
+                    auto start = std::chrono::steady_clock::now();
+                    if(doJump) {
+                        engine->stepPowerOfTwo(log2Generations, pool);
+                    } else {
+                        engine->step(pool);
+                        jumpRemaining--;
+                    }
+                    stepNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                }
+
+                dirty |= doStep || doJump || doJumpStep;
+
+                if(dirty && frames.isConsumed()) {
+                    auto start = std::chrono::steady_clock::now();
+                    {
+                        TraceScope trace(tracer, "rasterize", Tracer::SimulationThread);
+                        rasterize(frames.getBack(), region, lod, counts);
+                    }
+                    rasterizeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                    frames.publish();
+                    dirty = false;
+                    stepsAhead = 0;
+                    msAhead = 0;
+                    if(onPublish)
+                        onPublish();
+                }
+            }
+        }
+
+        void rasterize(Frame& frame, const CellRegion& region, int lod, bool counts) {
+            frame.generation = engine->generation;
+            frame.view = region;
+            frame.lodLog = lod;
+            frame.withCounts = counts;
+
+            if(lod > 0)
+                reduce(frame);
+            else
+                pack(frame);
+
+            frame.counts.resize(counts ? (size_t) region.width * region.height : 0);
+            if(!counts)
+                return;
+            for(int y = 0; y < region.height; y++)
+                for(int x = 0; x < region.width; x++)
+                    frame.counts[x + (size_t) y * region.width] = engine->getNeighbourCount(region.x + x, region.y + y);
+        }
+
+        void pack(Frame& frame) {
+            const CellRegion& region = frame.view;
+            frame.rowWords = (region.width + 63) / 64;
+            frame.cells.resize((size_t) region.height * frame.rowWords);
+            pool->parallelFor(0, region.height, [&](int rowBegin, int rowEnd) {
+                for(int y = rowBegin; y < rowEnd; y++)
+                    engine->getRowBits(region.y + y, region.x, region.x + region.width, 
+                            frame.cells.data() + (size_t) y * frame.rowWords);
+            });
+        }
+
+        /*
+         * Density of every 2^lodLog square as 0 (dead) to 255 (alive).
+         * The engine counts squares that fit into the view, if a texel is larger
+         * than the short side it adds up group x group of them.
+         */
+        void reduce(Frame& frame) {
+            const CellRegion& region = frame.view;
+            int width = frame.getWidth();
+            int height = frame.getHeight();
+            int squareLog = frame.lodLog;
+            while(squareLog > 0 && ((region.width >> squareLog) == 0 || (region.height >> squareLog) == 0))
+                squareLog--;
+            int square = 1 << squareLog;
+            int group = 1 << (frame.lodLog - squareLog);
+            int squaresX = std::min(width * group, region.width >> squareLog);
+            int squaresY = std::min(height * group, region.height >> squareLog);
+
+            frame.density.resize((size_t) width * height);
+            pool->parallelFor(0, height, [&](int rowBegin, int rowEnd) {
+                std::vector<uint32_t> alive(squaresX);
+                std::vector<uint64_t> sum(width);
+                for(int y = rowBegin; y < rowEnd; y++) {
+                    std::fill(sum.begin(), sum.end(), 0);
+                    int syEnd = std::min((y + 1) * group, squaresY);
+                    for(int sy = y * group; sy < syEnd; sy++) {
+                        engine->getDensityRow(region.y + sy * square, squareLog, 
+                                region.x, region.x + squaresX * square, alive.data());
+                        for(int sx = 0; sx < squaresX; sx++)
+                            sum[sx / group] += alive[sx];
+                    }
+                    for(int x = 0; x < width; x++) {
+                        uint64_t cells = ((uint64_t) (std::min((x + 1) * group, squaresX) - x * group) 
+                            * (syEnd - y * group)) << (2 * squareLog);
+                        frame.density[x + (size_t) y * width] = sum[x] * 255 / cells;
+                    }
+                }
+            });
+        }
+};
+
+#endif /* SIMULATION_H */
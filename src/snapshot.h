@@ -0,0 +1,257 @@
+// 
+// snapshot.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "engine.h"
+#include "universe.h"
+
+/*
+ * Binary snapshot of a universe, the header is followed by the packed words of all rows.
+ * Engines with a flat cell array store their own layout ("nibble", "bitboard"),
+ * all others one bit per cell as returned by getRowBits ("bits").
+ * All fields are in host byte order.
+ */
+struct SnapshotHeader {
+    static const uint32_t currentVersion = 1;
+
+    char magic[8];          // "GOLSNAP"
+    uint32_t version;
+    uint32_t headerSize;    // Offset of the cell words
+    int64_t width;
+    int64_t height;
+    int64_t generation;
+    char rule[16];
+    char layout[16];
+    int64_t rowWords;       // Words per row
+    uint64_t reserved[6];
+};
+
+static_assert(sizeof(SnapshotHeader) == 128, "Snapshot header layout changed");
+
+inline bool snapshotError(const std::string& msg, const std::string& detail = "") {
+    std::cerr << "[Snapshot] " << msg;
+    if(!detail.empty())
+        std::cerr << ": " << detail;
+    std::cerr << "\n";
+    return false;
+}
+
+/*
+ * Writes snapshots on a background thread, the simulation is only blocked
+ * for copying the cells and continues while the copy is written to disk.
+ */
+class SnapshotWriter {
+    private:
+        std::thread thread;
+        std::atomic<bool> writing = false;
+
+    public:
+        SnapshotWriter() { }
+
+        ~SnapshotWriter() {
+            wait();
+        }
+
+        SnapshotWriter(const SnapshotWriter&) = delete;
+        SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+        /*
+         * Waits for the last snapshot to be written
+         */
+        void wait() {
+            if(thread.joinable())
+                thread.join();
+        }
+
+        bool isWriting() { return writing; }
+
+        /*
+         * Takes a snapshot of the engine, must be called on the thread owning the engine.
+         * All cells are copied into a second buffer of the universe's size, which doubles
+         * the memory of the cells until the write finished.
+         * While the previous snapshot is still being written nothing is saved and false returned.
+         */
+        bool save(Engine* engine, const std::string& path) {
+            if(writing) {
+                std::cout << "[Snapshot] Previous snapshot still being written, skipped generation " 
+                    << engine->generation << "\n";
+                return false;
+            }
+            // Already finished, only joined
+            wait();
+            writing = true;
+
+            SnapshotHeader header = {};
+            std::memcpy(header.magic, "GOLSNAP", 8);
+            header.version = SnapshotHeader::currentVersion;
+            header.headerSize = sizeof(SnapshotHeader);
+            header.width = engine->width;
+            header.height = engine->height;
+            header.generation = engine->generation;
+            std::strncpy(header.rule, "B3/S23", sizeof(header.rule));
+
+            std::string layout;
+            size_t rowWords = 0;
+            auto words = std::make_shared<std::vector<uint64_t>>();
+            const uint64_t* native = engine->getWords(layout, rowWords);
+            if(native != nullptr) {
+                words->assign(native, native + rowWords * engine->height);
+            } else {
+                layout = "bits";
+                rowWords = (engine->width + 63) / 64;
+                words->resize(rowWords * engine->height);
+                for(int y = 0; y < engine->height; y++)
+                    engine->getRowBits(y, 0, engine->width, words->data() + y * rowWords);
+            }
+            std::strncpy(header.layout, layout.c_str(), sizeof(header.layout) - 1);
+            header.rowWords = rowWords;
+
+            thread = std::thread([this, header, words, path]() {
+                // Written next to the target and renamed, an interrupted write never replaces a good snapshot
+                std::string tempPath = path + ".tmp";
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                file.write((const char*) &header, sizeof(header));
+                file.write((const char*) words->data(), words->size() * sizeof(uint64_t));
+                file.close();
+                if(!file || std::rename(tempPath.c_str(), path.c_str()) != 0)
+                    snapshotError("Failed to write snapshot", path);
+                else
+                    std::cout << "[Snapshot] Saved generation " << header.generation << " to " << path << "\n";
+                writing = false;
+            });
+            return true;
+        }
+};
+
+inline bool checkSnapshotHeader(const SnapshotHeader& header, size_t fileSize, const std::string& path) {
+    if(std::memcmp(header.magic, "GOLSNAP", 8) != 0)
+        return snapshotError("Not a snapshot file", path);
+    if(header.version != SnapshotHeader::currentVersion)
+        return snapshotError("Unsupported snapshot version", std::to_string(header.version));
+    if(std::string(header.rule, strnlen(header.rule, sizeof(header.rule))) != "B3/S23")
+        return snapshotError("Unsupported rule", header.rule);
+    if(header.width <= 0 || header.height <= 0 || header.rowWords <= 0 || header.headerSize < sizeof(header)
+            || header.headerSize % 8 != 0
+            || fileSize < header.headerSize + (uint64_t) header.rowWords * header.height * sizeof(uint64_t))
+        return snapshotError("Snapshot file is truncated or corrupt", path);
+
+    // Rows are read with the width of the universe, they must hold all of its cells
+    std::string layout(header.layout, strnlen(header.layout, sizeof(header.layout)));
+    uint64_t minRowWords = layout == "nibble" ? ((uint64_t) header.width + 15) / 16 : ((uint64_t) header.width + 63) / 64;
+    if((uint64_t) header.rowWords < minRowWords)
+        return snapshotError("Snapshot rows are shorter than its width", path);
+    return true;
+}
+
+/*
+ * Reads only the header, e.g. to create an engine of the snapshot's size before loading it
+ */
+inline bool readSnapshotHeader(const std::string& path, SnapshotHeader& header) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+        return snapshotError("Failed to open snapshot", path);
+    size_t fileSize = file.tellg();
+    file.seekg(0);
+    if(!file.read((char*) &header, sizeof(header)))
+        return snapshotError("Not a snapshot file", path);
+    return checkSnapshotHeader(header, fileSize, path);
+}
+
+/*
+ * Replaces the universe with the snapshot, the engine must have the snapshot's size.
+ * The file is memory mapped, an engine with the same layout copies its cells
+ * straight out of the mapping, other engines are filled row by row.
+ */
+inline bool loadSnapshot(const std::string& path, Engine* engine) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return snapshotError("Failed to open snapshot", path);
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(SnapshotHeader)) {
+        close(fd);
+        return snapshotError("Not a snapshot file", path);
+    }
+    size_t fileSize = info.st_size;
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return snapshotError("Failed to map snapshot", path);
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+    const char* data = (const char*) mapping;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+        return snapshotError("Failed to open snapshot", path);
+    size_t fileSize = file.tellg();
+    if(fileSize < sizeof(SnapshotHeader))
+        return snapshotError("Not a snapshot file", path);
+    file.seekg(0);
+    std::vector<uint64_t> content((fileSize + 7) / 8);
+    file.read((char*) content.data(), fileSize);
+    const char* data = (const char*) content.data();
+#endif
+
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    bool loaded = checkSnapshotHeader(header, fileSize, path);
+    if(loaded && (header.width != engine->width || header.height != engine->height)) {
+        loaded = snapshotError("Snapshot size differs from the universe",
+                std::to_string(header.width) + "x" + std::to_string(header.height));
+    }
+
+    if(loaded) {
+        std::string layout(header.layout, strnlen(header.layout, sizeof(header.layout)));
+        const uint64_t* words = (const uint64_t*) (data + header.headerSize);
+
+        if(!engine->setWords(layout, header.rowWords, words)) {
+            std::vector<uint64_t> row(engine->width / 16 + 2);
+            for(int y = 0; y < engine->height && loaded; y++) {
+                const uint64_t* src = words + (size_t) y * header.rowWords;
+                if(layout == "nibble") {
+                    std::fill(row.begin(), row.end(), 0);
+                    for(int x = 0; x * 16 < engine->width; x++)
+                        Engine::appendBits(row.data(), x * 16, Universe::packBlock(src[x]), 16);
+                    engine->setRowBits(y, 0, engine->width, row.data());
+                } else if(layout == "bitboard" || layout == "bits") {
+                    engine->setRowBits(y, 0, engine->width, src);
+                } else {
+                    loaded = snapshotError("Unknown snapshot layout", layout);
+                }
+            }
+        }
+        if(loaded)
+            engine->generation = header.generation;
+    }
+
+#ifndef _WIN32
+    munmap(mapping, fileSize);
+#endif
+    return loaded;
+}
+
+#endif /* SNAPSHOT_H */
@@ -208,7 +208,7 @@ class Texture {
             SDL_UpdateTexture(m_texture, clip, pixels, pitch);
         }
 
-        int lock(const SDL_Rect* rect, void** pixels, int* pitch) {
+        bool lock(const SDL_Rect* rect, void** pixels, int* pitch) {
             return SDL_LockTexture(m_texture, rect, pixels, pitch);
         }
 
@@ -216,6 +216,17 @@ class Texture {
             SDL_UnlockTexture(m_texture);
         }
 
+        /*
+         * Palette of an indexed texture, needs SDL 3.4 or newer
+         */
+        bool setPalette(SDL_Palette* palette) {
+#if SDL_VERSION_ATLEAST(3, 4, 0)
+            return SDL_SetTexturePalette(m_texture, palette);
+#else
+            return false;
+#endif
+        }
+
         static SDL_Palette* generateGrayscalePalette(const int steps) {
             SDL_Palette* pal = SDL_CreatePalette(steps);
             std::vector<SDL_Color> colors(steps);
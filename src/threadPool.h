@@ -0,0 +1,122 @@
+// 
+// threadPool.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Persistent pool of worker threads, created once and reused for every generation.
+ * parallelFor splits a range into one band per thread, the calling thread
+ * works on the first band and returns once all bands are done.
+ */
+class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable startCondition;
+        std::condition_variable doneCondition;
+
+        const std::function<void(int, int)>* task = nullptr;
+        int taskBegin = 0;
+        int taskEnd = 0;
+        int taskBands = 0;
+        long jobId = 0;
+        int pending = 0;
+        bool stopping = false;
+
+    public:
+        ThreadPool(int numThreads = 0) {
+            if(numThreads <= 0)
+                numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+            for(int i = 1; i < numThreads; i++)
+                workers.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            startCondition.notify_all();
+            for(auto& worker : workers)
+                worker.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        int size() { return workers.size() + 1; }
+
+        /*
+         * Calls fn(bandBegin, bandEnd) for consecutive bands covering [begin, end).
+         * Bands are at least minBandSize long, small ranges run on the calling thread only.
+         */
+        void parallelFor(int begin, int end, const std::function<void(int, int)>& fn, int minBandSize = 1) {
+            int bands = std::min(size(), std::max(1, (end - begin) / std::max(minBandSize, 1)));
+            if(bands <= 1) {
+                fn(begin, end);
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                task = &fn;
+                taskBegin = begin;
+                taskEnd = end;
+                taskBands = bands;
+                pending = bands - 1;
+                jobId++;
+            }
+            startCondition.notify_all();
+
+            runBand(0);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            doneCondition.wait(lock, [this] { return pending == 0; });
+            task = nullptr;
+        }
+
+    private:
+        void runBand(int band) {
+            long length = taskEnd - taskBegin;
+            int bandBegin = taskBegin + length * band / taskBands;
+            int bandEnd = taskBegin + length * (band + 1) / taskBands;
+            (*task)(bandBegin, bandEnd);
+        }
+
+        void workerLoop(int index) {
+            long lastJob = 0;
+            while(true) {
+                std::unique_lock<std::mutex> lock(mutex);
+                startCondition.wait(lock, [&] { return stopping || jobId != lastJob; });
+                if(stopping)
+                    return;
+                lastJob = jobId;
+                bool hasBand = index < taskBands;
+                lock.unlock();
+
+                if(!hasBand)
+                    continue;
+
+                runBand(index);
+
+                lock.lock();
+                if(--pending == 0)
+                    doneCondition.notify_one();
+            }
+        }
+};
+
+#endif /* THREADPOOL_H */
@@ -8,18 +8,105 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
 #include <vector>
 
+/*
+ * Log-linear histogram of durations in ns (as in HdrHistogram): every power of two is split 
+ * into 16 buckets, so percentiles are within 1/16 of the true value. Recording is O(1).
+ */
+class Histogram {
+    private:
+        static const int subBucketLog = 4;
+        static const int subBuckets = 1 << subBucketLog;
+
+        std::array<uint64_t, (64 - subBucketLog + 1) * subBuckets> counts {};
+        uint64_t total = 0;
+        long maxValue = 0;
+
+        static int bucket(uint64_t value) {
+            if(value < 2 * subBuckets)
+                return value;
+            int log = 63 - __builtin_clzll(value);
+            int sub = (value >> (log - subBucketLog)) & (subBuckets - 1);
+            return (log - subBucketLog + 1) * subBuckets + sub;
+        }
+
+        /*
+         * Largest value of the bucket
+         */
+        static uint64_t upperBound(int b) {
+            if(b < 2 * subBuckets)
+                return b;
+            int log = b / subBuckets + subBucketLog - 1;
+            uint64_t width = 1ull << (log - subBucketLog);
+            return ((uint64_t) (subBuckets + b % subBuckets) << (log - subBucketLog)) + width - 1;
+        }
+
+    public:
+        void record(long ns) {
+            ns = std::max(ns, 0L);
+            counts[bucket(ns)]++;
+            total++;
+            maxValue = std::max(maxValue, ns);
+        }
+
+        void reset() {
+            counts.fill(0);
+            total = 0;
+            maxValue = 0;
+        }
+
+        uint64_t getCount() const { return total; }
+
+        long getMaxNs() const { return maxValue; }
+
+        /*
+         * Value below which the given percentage of the recorded values lie
+         */
+        long getPercentileNs(double percentile) const {
+            if(total == 0)
+                return 0;
+            uint64_t rank = std::max<uint64_t>(1, (uint64_t) (percentile / 100 * total + 0.5));
+            uint64_t seen = 0;
+            for(int b = 0; b < (int) counts.size(); b++) {
+                seen += counts[b];
+                if(seen >= rank)
+                    return std::min<uint64_t>(upperBound(b), maxValue);
+            }
+            return maxValue;
+        }
+
+        double getPercentileMs(double percentile) const { return getPercentileNs(percentile) / 1e6; }
+
+        /*
+         * e.g. "p50 16.61  p90 16.80  p99 17.20  max 33.40 ms"
+         */
+        std::string toString() const {
+            std::stringstream stream;
+            stream << std::fixed << std::setprecision(2)
+                << "p50 " << getPercentileMs(50) << "  p90 " << getPercentileMs(90) 
+                << "  p99 " << getPercentileMs(99) << "  max " << maxValue / 1e6 << " ms";
+            return stream.str();
+        }
+};
+
 class Timer {
     private:
         std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
         std::chrono::time_point<std::chrono::high_resolution_clock> m_end;
         bool m_isRunning = false;
 
-        int index = 0;
+        size_t index = 0;
         std::vector<long> intervals;
         bool filled = false;
+        long sum = 0;
         
     public:
         Timer() { 
@@ -37,24 +124,33 @@ class Timer {
 
         void stop() { 
             m_end = std::chrono::high_resolution_clock::now();
-            if(!filled && index == intervals.size()-1) filled = true;
-            intervals[(index++)%intervals.size()] = getNs();
+            add(getNs());
             m_isRunning = false;
         }
 
+        /*
+         * Adds an interval measured elsewhere to the average
+         */
+        void add(long ns) {
+            sum += ns - intervals[index];
+            intervals[index] = ns;
+            index++;
+            if(index == intervals.size()) {
+                index = 0;
+                filled = true;
+            }
+        }
+
         void resume() {
             m_isRunning = true;
         }
 
-        double getAverageNs() {
-            double averageInterval = 0;
-            int size = filled ? intervals.size() : index;
-            for(int i = 0; i < size; i++)
-                averageInterval += (double) intervals[i]/size;
-            return averageInterval;
+        double getAverageNs() const {
+            size_t size = filled ? intervals.size() : index;
+            return size == 0 ? 0 : (double) sum / size;
         }
         
-        double getAverageMs() {
+        double getAverageMs() const {
             return getAverageNs()/1'000'000;
         }
 
@@ -0,0 +1,166 @@
+// 
+// tracer.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Timed scope of one thread, names must be string literals
+ */
+struct TraceEvent {
+    const char* name;
+    int thread;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+/*
+ * Records timed scopes of the render loop and the simulation thread into a ring buffer,
+ * the oldest events are overwritten once it is full.
+ * The events are written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ * Nothing is recorded until tracing is enabled.
+ */
+class Tracer {
+    public:
+        enum Thread { RenderLoop, SimulationThread };
+
+    private:
+        const size_t capacity;
+        std::vector<TraceEvent> events {};
+        size_t next = 0;
+        bool wrapped = false;
+        std::atomic<bool> enabled {false};
+        std::mutex mutex;
+        const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    public:
+        Tracer(size_t capacity = 1 << 20) : capacity(capacity) { }
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        /*
+         * Starts a new recording, the buffer is only allocated while tracing
+         */
+        void start() {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.assign(capacity, {});
+            next = 0;
+            wrapped = false;
+            enabled = true;
+        }
+
+        void stop() {
+            std::lock_guard<std::mutex> lock(mutex);
+            enabled = false;
+            events = std::vector<TraceEvent>();
+            next = 0;
+            wrapped = false;
+        }
+
+        bool isEnabled() { return enabled; }
+
+        int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+        }
+
+        void record(const char* name, int thread, int64_t startNs, int64_t durationNs) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!enabled)
+                return;
+            events[next] = {name, thread, startNs, durationNs};
+            next = (next + 1) % capacity;
+            wrapped |= next == 0;
+        }
+
+        /*
+         * Writes the recorded events, oldest first
+         */
+        bool write(const std::string& path) {
+            std::vector<TraceEvent> recorded {};
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(wrapped)
+                    recorded.insert(recorded.end(), events.begin() + next, events.end());
+                recorded.insert(recorded.end(), events.begin(), events.begin() + next);
+            }
+
+            std::string tempPath = path + ".tmp";
+            std::ofstream file(tempPath, std::ios::trunc);
+            if(!file.is_open())
+                return error("Failed to write trace", path);
+
+            // Microseconds with nanosecond precision
+            file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+            char line[256];
+            for(const TraceEvent& e : recorded) {
+                snprintf(line, sizeof(line), "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f},\n",
+                        e.name, e.thread, e.startNs / 1e3, e.durationNs / 1e3);
+                file << line;
+            }
+
+            const char* threadNames[] = {"render loop", "simulation"};
+            for(int t = 0; t < 2; t++) {
+                file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << t
+                    << ", \"args\": {\"name\": \"" << threadNames[t] << "\"}}" << (t == 0 ? "," : "") << "\n";
+            }
+            file << "]}\n";
+            file.close();
+
+            if(!file || std::rename(tempPath.c_str(), path.c_str()) != 0)
+                return error("Failed to write trace", path);
+            std::cout << "[Tracer] Wrote " << recorded.size() << " events to " << path << "\n";
+            return true;
+        }
+
+    private:
+        bool error(const std::string& msg, const std::string& detail = "") {
+            std::cerr << "[Tracer] " << msg;
+            if(!detail.empty())
+                std::cerr << ": " << detail;
+            std::cerr << "\n";
+            return false;
+        }
+};
+
+/*
+ * Records its scope as a trace event if tracing is enabled, the tracer can be nullptr
+ */
+class TraceScope {
+    private:
+        Tracer* tracer;
+        const char* name;
+        int thread;
+        int64_t startNs = 0;
+
+    public:
+        TraceScope(Tracer* tracer, const char* name, int thread = Tracer::RenderLoop) :
+        tracer(tracer != nullptr && tracer->isEnabled() ? tracer : nullptr), name(name), thread(thread) {
+            if(this->tracer != nullptr)
+                startNs = this->tracer->now();
+        }
+
+        ~TraceScope() {
+            if(tracer != nullptr)
+                tracer->record(name, thread, startNs, tracer->now() - startNs);
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#endif /* TRACER_H */
@@ -0,0 +1,63 @@
+// 
+// tripleBuffer.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/*
+ * Lock-free single producer, single consumer triple buffer.
+ * The writer fills the back buffer and publishes it by swapping it with the middle buffer,
+ * the reader swaps the middle buffer with its front buffer whenever a new one was published.
+ * Neither side ever waits, the reader always sees the latest completely written value.
+ */
+template <typename T>
+class TripleBuffer {
+    private:
+        // Set on the middle index if the middle buffer holds a value not yet read
+        static const int freshBit = 0x4;
+
+        T buffers[3];
+        std::atomic<int> middle {1};
+        int back = 0;   // Only used by the writer
+        int front = 2;  // Only used by the reader
+
+    public:
+        TripleBuffer(const T& init = T()) : buffers{init, init, init} { }
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /*
+         * Writer side
+         */
+        T& getBack() { return buffers[back]; }
+
+        void publish() {
+            back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & ~freshBit;
+        }
+
+        // True once the reader picked up the last published buffer
+        bool isConsumed() {
+            return (middle.load(std::memory_order_acquire) & freshBit) == 0;
+        }
+
+        /*
+         * Reader side, returns true if the front buffer was replaced by a newer one
+         */
+        bool update() {
+            if((middle.load(std::memory_order_acquire) & freshBit) == 0)
+                return false;
+            front = middle.exchange(front, std::memory_order_acq_rel) & ~freshBit;
+            return true;
+        }
+
+        const T& getFront() { return buffers[front]; }
+};
+
+#endif /* TRIPLEBUFFER_H */
@@ -0,0 +1,417 @@
+// 
+// universe.h
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#ifndef UNIVERSE_H
+#define UNIVERSE_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+#include "kernel.h"
+#include "threadPool.h"
+
+/*
+ * Nibble engine, the default engine.
+ * Every array entry packs 16 horizontal cells into 4 bit nibbles,
+ * the lowest bit of each nibble being the cell state.
+ *
+ * Any width is allowed, rows are padded to full blocks. If there is padding, 
+ * the first padding cell mirrors the first cell of the row and the last padding cell 
+ * the last cell, so the kernels wrap around the torus without special cases. 
+ * All other padding cells are kept dead.
+ *
+ * The universe is split into tiles of 16 blocks x 64 rows (256 x 64 cells).
+ * Only tiles that changed in the last generation or border such a tile
+ * are recomputed, all other tiles are stable and keep their state in both buffers.
+ */
+class Universe : public Engine {
+    public:
+        const int rowLength = 0;
+        const int numRows = 0;
+        const size_t arrayLength = 0;
+
+        const uint64_t cellMaskAlive = 0x1;
+        const uint64_t cellMaskCount = 0xF;
+
+        uint64_t* cells;
+        uint64_t* swap;
+
+        RowKernel rowKernel = selectRowKernel();
+
+        const int tileBlocks = 0;
+        const int tileRows = 0;
+        const int tilesX = 0;
+        const int tilesY = 0;
+
+        // Per tile flag, set if the tile changed in the last generation or was edited
+        std::vector<uint8_t> tileChanged;
+        std::vector<uint8_t> tileChangedNext;
+        bool sparse = true;
+
+    public:
+        Universe(int width, int height) :
+        Engine(std::max(width, 1), std::max(height, 1)),
+        rowLength(paddedRowLength(this->width)), // Every array entry packs 16 horizontal cells
+        numRows(this->height),
+        arrayLength((size_t) rowLength * numRows),
+        tileBlocks(std::min(rowLength, 16)),
+        tileRows(std::min(numRows, 64)),
+        tilesX((rowLength + tileBlocks - 1) / tileBlocks),
+        tilesY((numRows + tileRows - 1) / tileRows) {
+            cells = new uint64_t[arrayLength]();
+            swap = new uint64_t[arrayLength]();
+            tileChanged = std::vector<uint8_t>((size_t) tilesX * tilesY, 1);
+            tileChangedNext = std::vector<uint8_t>((size_t) tilesX * tilesY, 1);
+        }
+
+        ~Universe() {
+            delete[] cells;
+            delete[] swap;
+        }
+
+        std::string getName() { return std::string("nibble/") + rowKernel.name; }
+
+        /*
+         * Blocks per row, a single padding cell can not mirror both ends of the row
+         */
+        static int paddedRowLength(int width) {
+            int length = (width + 15) / 16;
+            if(length * 16 - width == 1)
+                length++;
+            return length;
+        }
+
+        uint64_t* row(int y) { return cells + (size_t) y * rowLength; }
+
+        void initGolRandom() {
+            generation = 0;
+            initGolClear();
+            for(size_t i = 0; i < arrayLength; i++) {
+                for(int j = 0; j < 16; j++)  {
+                    cells[i] |= (cellMaskAlive & (rand() % 3 < 1)) << (j*4);
+                }
+            }
+            updatePadding();
+        }
+
+        void initGolClear() {
+            generation = 0;
+            for(size_t i = 0; i < arrayLength; i++) { cells[i] = 0x0; }
+            markAllChanged();
+        }
+
+        void initGolFull() {
+            generation = 0;
+            for(size_t i = 0; i < arrayLength; i++) {
+                cells[i] = 0x1111111111111111;
+            }
+            updatePadding();
+            markAllChanged();
+        }
+
+        void markAllChanged() {
+            std::fill(tileChanged.begin(), tileChanged.end(), 1);
+        }
+
+        void markCellChanged(int gx, int gy) {
+            tileChanged[(gx/16) / tileBlocks + (size_t) (gy / tileRows) * tilesX] = 1;
+        }
+
+        /*
+         * Rewrites the padding cells of row y from its first and last cell,
+         * tiles with changed padding are marked as changed
+         */
+        void updateRowPadding(int y) {
+            uint64_t* r = row(y);
+            uint64_t first = (r[0] >> 60) & cellMaskAlive;
+            uint64_t last = (r[(width-1)/16] >> (4 * (15 - (width-1)%16))) & cellMaskAlive;
+
+            for(int x = width/16; x < rowLength; x++) {
+                int real = std::max(0, width - x*16);
+                uint64_t block = real == 0 ? 0 : r[x] & (~0ull << (4 * (16 - real)));
+                if(x == width/16)
+                    block |= first << (4 * (15 - width%16));
+                if(x == rowLength-1)
+                    block |= last;
+
+                if(block != r[x]) {
+                    r[x] = block;
+                    tileChanged[x / tileBlocks + (size_t) (y / tileRows) * tilesX] = 1;
+                }
+            }
+        }
+
+        void updatePadding() {
+            if(rowLength * 16 == width)
+                return;
+            for(int y = 0; y < numRows; y++)
+                updateRowPadding(y);
+        }
+
+        /*
+         * A tile has to be recomputed if it or one of its 8 neighbours changed
+         */
+        bool isTileActive(int tx, int ty) {
+            if(!sparse)
+                return true;
+
+            for(int dy = -1; dy <= 1; dy++) {
+                int y = (ty + dy + tilesY) % tilesY;
+                for(int dx = -1; dx <= 1; dx++) {
+                    int x = (tx + dx + tilesX) % tilesX;
+                    if(tileChanged[x + (size_t) y * tilesX])
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        bool rowChanged(int gy) {
+            int ty = gy / tileRows;
+            for(int tx = 0; tx < tilesX; tx++)
+                if(tileChanged[tx + (size_t) ty * tilesX])
+                    return true;
+            return false;
+        }
+
+        int activeTiles() {
+            int active = 0;
+            for(int ty = 0; ty < tilesY; ty++)
+                for(int tx = 0; tx < tilesX; tx++)
+                    active += isTileActive(tx, ty);
+            return active;
+        }
+
+        /*
+         * Selects the row kernel by name ("scalar", "avx2", "avx512"),
+         * an empty name picks the widest kernel the cpu supports
+         */
+        void setKernel(const std::string& name) {
+            rowKernel = selectRowKernel(name);
+            if(!name.empty() && name != rowKernel.name)
+                error("Kernel not supported, falling back to", rowKernel.name);
+        }
+
+        /*
+         * Scalar reference for a single block, see nextBlock in kernel.h
+         */
+        void nextBlockState(int x, int y) {
+            int nR = (y + 1) >= numRows   ?           0 : y+1;
+            int pR = (y - 1) <          0 ?   numRows-1 : y-1;
+
+            nextBlockScalar(row(pR), row(y), row(nR), swap + (size_t) y * rowLength, rowLength, x);
+        }
+
+        /*
+         * Computes all active tiles of the tile rows [tileRowBegin, tileRowEnd).
+         * Inactive tiles are skipped, their swap entries already hold the same state as cells.
+         */
+        void computeTileRows(int tileRowBegin, int tileRowEnd) {
+            std::vector<uint8_t> active(tilesX);
+            for(int ty = tileRowBegin; ty < tileRowEnd; ty++) {
+                bool anyActive = false;
+                for(int tx = 0; tx < tilesX; tx++) {
+                    active[tx] = isTileActive(tx, ty);
+                    anyActive |= active[tx];
+                }
+
+                if(!anyActive)
+                    continue;
+
+                // Row by row through the tile row to keep the memory access sequential
+                int rowEnd = std::min((ty + 1) * tileRows, numRows);
+                for(int y = ty * tileRows; y < rowEnd; y++) {
+                    int nR = (y + 1) >= numRows   ?           0 : y+1;
+                    int pR = (y - 1) <          0 ?   numRows-1 : y-1;
+
+                    rowKernel.fn(row(pR), row(y), row(nR), swap + (size_t) y * rowLength, rowLength, 
+                            tileBlocks, active.data(), &tileChangedNext[(size_t) ty * tilesX]);
+                }
+            }
+        }
+
+        /*
+         * Computes the next generation into swap without touching any pixels.
+         * Blocks only read cells and only write their own swap entry,
+         * so the tile rows can be split into independent bands.
+         */
+        void computeNext(ThreadPool* pool = nullptr) {
+            std::fill(tileChangedNext.begin(), tileChangedNext.end(), 0);
+
+            if(pool == nullptr) {
+                computeTileRows(0, tilesY);
+                return;
+            }
+
+            pool->parallelFor(0, tilesY, [this](int tileRowBegin, int tileRowEnd) {
+                computeTileRows(tileRowBegin, tileRowEnd);
+            });
+        }
+
+        void swapBuffers() {
+            uint64_t* temp = cells;
+            cells = swap;
+            swap = temp;
+            tileChanged.swap(tileChangedNext);
+            updatePadding();
+            generation++;
+        }
+
+        void step(ThreadPool* pool = nullptr) {
+            computeNext(pool);
+            swapBuffers();
+        }
+
+        uint64_t population() {
+            int fullBlocks = width / 16;
+            uint64_t tailMask = width % 16 == 0 ? 0 : ~0ull << (4 * (16 - width%16));
+
+            uint64_t alive = 0;
+            for(int y = 0; y < numRows; y++) {
+                const uint64_t* r = row(y);
+                for(int x = 0; x < fullBlocks; x++)
+                    alive += __builtin_popcountll(r[x]);
+                alive += __builtin_popcountll(r[fullBlocks % rowLength] & tailMask);
+            }
+            return alive;
+        }
+
+        const uint64_t* getWords(std::string& layout, size_t& rowWords) {
+            layout = "nibble";
+            rowWords = rowLength;
+            return cells;
+        }
+
+        bool setWords(const std::string& layout, size_t rowWords, const uint64_t* words) {
+            if(layout != "nibble" || rowWords != (size_t) rowLength)
+                return false;
+            std::memcpy(cells, words, arrayLength * sizeof(uint64_t));
+            markAllChanged();
+            return true;
+        }
+
+        bool getCellState(int gx, int gy) {
+            int offset = (15 - gx%16) * 4;
+            uint64_t block = row(gy)[gx/16];
+
+            return block & (cellMaskAlive << offset);
+        }
+
+        void invertCellState(int gx, int gy) {
+            markCellChanged(gx, gy);
+            int offset = (15-gx%16) * 4;
+            row(gy)[gx/16] ^= cellMaskAlive << offset;
+            updateRowPadding(gy);
+        }
+
+        void setCellState(int gx, int gy) {
+            markCellChanged(gx, gy);
+            int offset = (15-gx%16) * 4;
+            row(gy)[gx/16] |= cellMaskAlive << offset;
+            updateRowPadding(gy);
+        }
+
+        void unsetCellState(int gx, int gy) {
+            markCellChanged(gx, gy);
+            int offset = (15-gx%16) * 4;
+            row(gy)[gx/16] &= ~(cellMaskAlive << offset);
+            updateRowPadding(gy);
+        }
+
+        int getNeighbourCount(int gx, int gy) {
+            int x = gx/16;
+            int nC = (x + 1) >= rowLength ?           0 : x+1;
+            int pC = (x - 1) <          0 ? rowLength-1 : x-1;
+            int nR = (gy + 1) >= numRows  ?           0 : gy+1;
+            int pR = (gy - 1) <          0 ?  numRows-1 : gy-1;
+            uint64_t* north = row(pR);
+            uint64_t* center = row(gy);
+            uint64_t* south = row(nR);
+
+            uint64_t r;
+            nextBlock(center[x],
+                    north[pC], north[x], north[nC],
+                    center[pC], center[nC],
+                    south[pC], south[x], south[nC],
+                    r);
+
+            int offset = (15 - gx%16) * 4;
+            return (r >> offset) & cellMaskCount;
+        }
+
+        /*
+         * Gathers the state bits of the 16 nibbles of a block into the lowest 16 bits,
+         * the leftmost cell ending up in bit 15
+         */
+        static uint64_t packBlock(uint64_t c) {
+            uint64_t x = c & 0x1111111111111111;
+            x = (x | (x >> 3))  & 0x0303030303030303;
+            x = (x | (x >> 6))  & 0x000F000F000F000F;
+            x = (x | (x >> 12)) & 0x000000FF000000FF;
+            x = (x | (x >> 24)) & 0xFFFF;
+            return x;
+        }
+
+        /*
+         * Inverse of packBlock, spreads the lowest 16 bits to the state bits of the nibbles
+         */
+        static uint64_t unpackBlock(uint64_t x) {
+            x &= 0xFFFF;
+            x = (x | (x << 24)) & 0x000000FF000000FF;
+            x = (x | (x << 12)) & 0x000F000F000F000F;
+            x = (x | (x << 6))  & 0x0303030303030303;
+            x = (x | (x << 3))  & 0x1111111111111111;
+            return x;
+        }
+
+        void setRowBits(int gy, int gxBegin, int gxEnd, const uint64_t* src) {
+            uint64_t* r = row(gy);
+            for(int gx = gxBegin; gx < gxEnd;) {
+                int blockEnd = std::min(gxEnd, (gx/16 + 1) * 16);
+                int n = blockEnd - gx;
+                int shift = 16 - gx%16 - n;
+                uint64_t mask = unpackBlock(((1ull << n) - 1) << shift);
+                r[gx/16] = (r[gx/16] & ~mask) | unpackBlock(extractBits(src, gx - gxBegin, n) << shift);
+                markCellChanged(gx, gy);
+                gx = blockEnd;
+            }
+            updateRowPadding(gy);
+        }
+
+        void getRowBits(int gy, int gxBegin, int gxEnd, uint64_t* dst) {
+            std::fill(dst, dst + (gxEnd - gxBegin + 63) / 64, 0);
+            const uint64_t* r = row(gy);
+            for(int gx = gxBegin; gx < gxEnd;) {
+                int blockEnd = std::min(gxEnd, (gx/16 + 1) * 16);
+                int n = blockEnd - gx;
+                uint64_t bits = packBlock(r[gx/16]) >> (16 - gx%16 - n);
+                appendBits(dst, gx - gxBegin, bits & ((1ull << n) - 1), n);
+                gx = blockEnd;
+            }
+        }
+
+        void debugCellArray() {
+            assert(arrayLength <= 512);
+            std::cout << "Full cell Array: \n";
+            for(int y = 0; y < numRows; y++) {
+                for(int x = 0; x < rowLength; x++) {
+                    std::cout << std::dec << x + y*rowLength << ": "
+                        << std::hex << cells[x + y * rowLength]
+                        << std::dec << (x != rowLength-1 ? ", " : "\n");
+                }
+            }
+            std::cout << "\n";
+        }
+};
+
+#endif /* UNIVERSE_H */
@@ -0,0 +1,41 @@
+// 
+// verify.cpp
+// ConwaysGameOfLife
+// 
+// Noah Hitz 2025
+// 
+
+#include "conformance.h"
+
+void usage(const char* name) {
+    std::cerr << "Usage: " << name << " [options]\n"
+        << "Options: --gens G       generations per case (default: 1000)\n"
+        << "         --seed S       seed of the random soups (default: 1)\n"
+        << "         --threads T    number of simulation threads (default: all cores, at least 4)\n"
+        << "         --engine E     only engines starting with E, e.g. nibble/avx2, bitboard\n";
+}
+
+int main(int argc, char *argv[]) {
+    ConformanceOptions options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+
+        if(arg == "--gens" && hasValue) {
+            options.generations = std::stol(argv[++i]);
+        } else if(arg == "--seed" && hasValue) {
+            options.seed = std::stoul(argv[++i]);
+        } else if(arg == "--threads" && hasValue) {
+            options.threads = std::stoi(argv[++i]);
+        } else if(arg == "--engine" && hasValue) {
+            options.engine = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    ConformanceRunner runner = ConformanceRunner(options);
+    return runner.run();
+}